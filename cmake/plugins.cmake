@@ -0,0 +1,12 @@
+
+# Adds a renderer or window plugin. Plugins are shared libraries loaded at
+# runtime, except the pair named by ENGINE_STATIC_RENDERER and
+# ENGINE_STATIC_WINDOW, which is linked into the engine instead.
+macro(add_plugin_library TARGET)
+    if ("${TARGET}" STREQUAL "${ENGINE_STATIC_RENDERER}_renderer" OR
+        "${TARGET}" STREQUAL "${ENGINE_STATIC_WINDOW}_${ENGINE_STATIC_RENDERER}_window")
+        add_library(${TARGET} STATIC ${ARGN})
+    else ()
+        add_library(${TARGET} SHARED ${ARGN})
+    endif ()
+endmacro()
@@ -6,4 +6,26 @@ macro(make_shaders NAME_IN NAME_OUT)
         file(READ ${SHADER} ${SHADERNAME})
     endforeach ()
     configure_file(${NAME_IN} ${NAME_OUT} @ONLY)
-endmacro()
\ No newline at end of file
+endmacro()
+
+# Compiles every shaders/* file of the current directory to SPIR-V with glslc
+# and adds the results to TARGET as ${CMAKE_CURRENT_BINARY_DIR}/spirv/<name>.inc,
+# a comma separated list of words meant to be included into a uint32_t array.
+macro(compile_shaders TARGET)
+    find_program(GLSLC_EXECUTABLE glslc HINTS "$ENV{VULKAN_SDK}/bin" REQUIRED)
+    file(GLOB SHADERS shaders/*)
+    foreach(SHADER ${SHADERS})
+        get_filename_component(SHADERNAME ${SHADER} NAME)
+        set(SPIRV ${CMAKE_CURRENT_BINARY_DIR}/spirv/${SHADERNAME}.inc)
+        add_custom_command(
+                OUTPUT ${SPIRV}
+                COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_CURRENT_BINARY_DIR}/spirv
+                COMMAND ${GLSLC_EXECUTABLE} -mfmt=num -o ${SPIRV} ${SHADER}
+                DEPENDS ${SHADER}
+                COMMENT "Compiling ${SHADERNAME} to SPIR-V"
+                VERBATIM
+        )
+        target_sources(${TARGET} PRIVATE ${SPIRV})
+    endforeach ()
+    target_include_directories(${TARGET} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endmacro()
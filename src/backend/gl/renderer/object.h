@@ -9,6 +9,7 @@
 namespace gl {
 
 struct Object {
+  ArrayObject vao;
   ArrayObject vbo;
   ArrayObject ebo;
 
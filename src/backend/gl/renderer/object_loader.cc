@@ -11,6 +11,7 @@
 #include "engine/render/types.h"
 #include "engine/render/data_util.h"
 #include "obj/parser.h"
+#include "trace/trace.h"
 
 namespace gl {
 
@@ -41,7 +42,11 @@ ArrayObject LoadDummyTexture()  {
 
 ArrayObject LoadTexture(const std::string& path) {
   int image_width, image_height, image_channels;
-  const std::unique_ptr<stbi_uc, void(*)(void*)> pixels(stbi_load(path.c_str(), &image_width, &image_height, &image_channels, STBI_rgb_alpha), stbi_image_free);
+  std::unique_ptr<stbi_uc, void(*)(void*)> pixels(nullptr, stbi_image_free);
+  {
+    TRACE_ZONE("decode texture");
+    pixels.reset(stbi_load(path.c_str(), &image_width, &image_height, &image_channels, STBI_rgb_alpha));
+  }
   if (pixels == nullptr) {
     return LoadDummyTexture();
   }
@@ -67,8 +72,12 @@ void ObjectLoader::Init() {
 }
 
 Object ObjectLoader::Load(const std::string& path) const {
+  TRACE_ZONE("ObjectLoader::Load");
   obj::Data data = obj::ParseFromFile(path);
 
+  ArrayObject vao(1, glGenVertexArrays, glDeleteVertexArrays);
+  glBindVertexArray(vao.Value());
+
   ArrayObject ebo(1, glGenBuffers, glDeleteBuffers);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.Value());
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(engine::Index) * data.indices.size()),  nullptr, GL_STATIC_DRAW);
@@ -100,9 +109,11 @@ Object ObjectLoader::Load(const std::string& path) const {
 
   glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
   glUnmapBuffer(GL_ARRAY_BUFFER);
+  glBindVertexArray(0);
 
   Object object = {};
 
+  object.vao = std::move(vao);
   object.vbo = std::move(vbo);
   object.ebo = std::move(ebo);
   object.textures = LoadTextures(data);
@@ -2,16 +2,23 @@
 
 #include <GL/glew.h>
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "backend/gl/renderer/error.h"
 #include "backend/gl/renderer/object_loader.h"
 #include "backend/gl/renderer/shaders.h"
+#include "trace/trace.h"
 
 namespace gl {
 
 namespace {
 
+// Frames of timer queries in flight, enough for results to be ready when
+// reused.
+constexpr size_t kTimerFrameCount = 4;
+
 inline void CompileShader(const char* source, const GLuint shader) {
   glShaderSource(shader, 1, &source, nullptr);
   glCompileShader(shader);
@@ -33,7 +40,13 @@ inline void LinkShaderProgram(const GLuint program) {
 }
 
 ValueObject ShaderProgramCreate() {
-  if (glewInit() != GLEW_OK) {
+  // A GLX build of GLEW reports a missing X display under EGL, yet its entry
+  // points still resolve through the dispatching libGL.
+  if (const GLenum result = glewInit(); result != GLEW_OK
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+      && result != GLEW_ERROR_NO_GLX_DISPLAY
+#endif
+  ) {
     throw Error("Failed to gl loader");
   }
   glEnable(GL_DEPTH_TEST);
@@ -50,43 +63,244 @@ ValueObject ShaderProgramCreate() {
   for(const ValueObject& shader : shaders) {
     glAttachShader(program.Value(), shader.Value());
   }
+  // Generic attribute 0 must be a per-vertex array, so keep the instanced
+  // model matrix off it.
+  glBindAttribLocation(program.Value(), 0, "inPosition");
   LinkShaderProgram(program.Value());
   glUseProgram(program.Value());
 
   return program;
 }
 
+// The model matrix occupies one attribute location per column and advances
+// once per instance.
+inline void EnableModelAttribute(const GLuint location) {
+  for(GLuint i = 0; i < 4; ++i) {
+    glEnableVertexAttribArray(location + i);
+    glVertexAttribDivisor(location + i, 1);
+  }
+}
+
+inline void SetModelAttribute(const GLuint location, const uint32_t first_instance) {
+  const size_t offset = sizeof(glm::mat4) * first_instance;
+  for(GLuint i = 0; i < 4; ++i) {
+    glVertexAttribPointer(location + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void*>(offset + sizeof(glm::vec4) * i));
+  }
+}
+
+// GL cannot queue frames without tearing, so mailbox is treated like
+// immediate and both only skip the wait for vertical blank.
+void ApplyPresentMode(Window& window, const engine::PresentMode present_mode) {
+  int interval = 1;
+  switch (present_mode) {
+    case engine::PresentMode::kFifo:
+      interval = 1;
+      break;
+    case engine::PresentMode::kFifoRelaxed:
+      interval = -1;
+      break;
+    case engine::PresentMode::kMailbox:
+    case engine::PresentMode::kImmediate:
+    case engine::PresentMode::kLowestLatency:
+      interval = 0;
+      break;
+  }
+  if (!window.SetSwapInterval(interval)) {
+    window.SetSwapInterval(1);
+  }
+}
+
+double GetElapsedTime(const GLuint query) {
+  GLuint64 elapsed = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+  return static_cast<double>(elapsed) / 1e6;
+}
+
 } // namespace
 
-Renderer::Renderer(Window& window)
+Renderer::Renderer(Window& window, const engine::RendererOptions& options)
     : window_(window),
       program_(ShaderProgramCreate()),
       uniform_updater_(program_.Value()),
-      object_() {
+      uniforms_version_(0),
+      model_location_(glGetAttribLocation(program_.Value(), "inModel")),
+      instances_(1, glGenBuffers, glDeleteBuffers),
+      draw_stats_(),
+      frame_fence_idx_(0),
+      timed_frames_(0),
+      gpu_timings_() {
+  // The context is current on the window's thread, which also swaps.
+  if (options.render_thread) {
+    throw Error("Failed to render on a render thread, unsupported by gl");
+  }
   ObjectLoader::Init();
+  ApplyPresentMode(window, options.present_mode);
+  if (GLEW_VERSION_3_2 || GLEW_ARB_sync) {
+    frame_fences_.assign(std::max<uint32_t>(options.frames_in_flight, 1), nullptr);
+  }
+  if (options.gpu_profiler && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query)) {
+    timer_frames_.resize(kTimerFrameCount);
+  }
   window.SetWindowResizedCallback([](const int width, const int height) {
     glViewport(0, 0, width, height);
   });
 }
 
-void Renderer::LoadModel(const std::string& path) {
-  object_ = ObjectLoader(program_).Load(path);
+engine::MeshId Renderer::LoadMesh(const std::string& path) {
+  meshes_.push_back(ObjectLoader(program_).Load(path));
+
+  return static_cast<engine::MeshId>(meshes_.size() - 1);
+}
+
+Renderer::~Renderer() {
+  for(GLsync fence : frame_fences_) {
+    glDeleteSync(fence);
+  }
 }
 
 void Renderer::RenderFrame() {
+  TRACE_ZONE("Renderer::RenderFrame");
+  WaitForFrame();
+  ReadTimerQueries();
+  DrawScene();
+  if (!timer_frames_.empty()) {
+    timer_frames_[timed_frames_++ % timer_frames_.size()].issued = true;
+  }
+  if (!frame_fences_.empty()) {
+    frame_fences_[frame_fence_idx_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame_fence_idx_ = (frame_fence_idx_ + 1) % frame_fences_.size();
+  }
+}
+
+// Blocks until the frame rendered frames_in_flight frames ago is complete.
+void Renderer::WaitForFrame() {
+  if (frame_fences_.empty() || frame_fences_[frame_fence_idx_] == nullptr) {
+    return;
+  }
+  TRACE_ZONE("wait for frame fence");
+  GLsync& fence = frame_fences_[frame_fence_idx_];
+  if (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, std::numeric_limits<GLuint64>::max()) == GL_WAIT_FAILED) {
+    throw Error("Failed to wait for frame fence");
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+// Reads back the queries issued kTimerFrameCount frames ago when the GPU is
+// done with them, so the results never stall the pipeline, then clears the
+// frame for reuse.
+void Renderer::ReadTimerQueries() {
+  if (timer_frames_.empty()) {
+    return;
+  }
+  TimerFrame& timer_frame = timer_frames_[timed_frames_ % timer_frames_.size()];
+  if (!timer_frame.issued) {
+    return;
+  }
+  const size_t query_count = 1 + timer_frame.groups.size();
+  GLint available = GL_TRUE;
+  for(size_t i = 0; i < query_count && available == GL_TRUE; ++i) {
+    glGetQueryObjectiv(timer_frame.queries[i].Value(), GL_QUERY_RESULT_AVAILABLE, &available);
+  }
+  if (available == GL_TRUE) {
+    const double upload_time = GetElapsedTime(timer_frame.queries[0].Value());
+    double draw_time = 0.0;
+    gpu_timings_.groups = timer_frame.groups;
+    for(size_t i = 0; i < gpu_timings_.groups.size(); ++i) {
+      gpu_timings_.groups[i].time = GetElapsedTime(timer_frame.queries[i + 1].Value());
+      draw_time += gpu_timings_.groups[i].time;
+    }
+    gpu_timings_.passes = {{"upload", upload_time}, {"draw", draw_time}};
+    gpu_timings_.frame = upload_time + draw_time;
+  }
+  timer_frame.groups.clear();
+  timer_frame.issued = false;
+}
+
+// Starts query idx of the current frame, creating it on first use.
+void Renderer::BeginTimerQuery(const size_t query) {
+  if (timer_frames_.empty()) {
+    return;
+  }
+  std::vector<ArrayObject>& queries = timer_frames_[timed_frames_ % timer_frames_.size()].queries;
+  while (queries.size() <= query) {
+    queries.emplace_back(1, glGenQueries, glDeleteQueries);
+  }
+  glBeginQuery(GL_TIME_ELAPSED, queries[query].Value());
+}
+
+// Starts the query of the next usemtl group of the current frame.
+void Renderer::BeginGroupTimerQuery(const engine::MeshId mesh, const uint32_t material) {
+  if (timer_frames_.empty()) {
+    return;
+  }
+  std::vector<engine::GpuGroupTime>& groups = timer_frames_[timed_frames_ % timer_frames_.size()].groups;
+  groups.push_back({mesh, material, 0.0});
+  BeginTimerQuery(groups.size());
+}
+
+void Renderer::EndTimerQuery() {
+  if (timer_frames_.empty()) {
+    return;
+  }
+  glEndQuery(GL_TIME_ELAPSED);
+}
+
+void Renderer::DrawScene() {
+  BeginTimerQuery(0);
   glClearColor(0, 0, 0, 1);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  uniform_updater_.Update(model_.GetUniforms());
+  if (const uint64_t version = scene_.GetUniformsVersion(); version != uniforms_version_) {
+    uniform_updater_.Update(scene_.GetUniforms());
+    uniforms_version_ = version;
+  }
+  scene_.UpdateTransforms();
+  draw_stats_ = {};
+
+  const size_t instance_count = scene_.GetObjectCount() + scene_.GetInstanceCount();
+  if (instance_count == 0) {
+    EndTimerQuery();
+    return;
+  }
+  // Orphan last frame's storage so the upload does not wait on its draws.
+  glBindBuffer(GL_ARRAY_BUFFER, instances_.Value());
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sizeof(glm::mat4) * instance_count), nullptr, GL_STREAM_DRAW);
+  auto transforms = static_cast<glm::mat4*>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+  if (transforms == nullptr) {
+    throw Error("Failed to map instance transforms");
+  }
+  scene_.CopyTransforms(transforms);
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+  EndTimerQuery();
+
+  const auto model_location = static_cast<GLuint>(model_location_);
+  mesh_instances_.resize(meshes_.size());
+  scene_.CollectInstanceRanges(mesh_instances_);
 
-  size_t prev_offset = 0;
+  for(size_t mesh = 0; mesh < meshes_.size(); ++mesh) {
+    const std::vector<engine::InstanceRange>& instances = mesh_instances_[mesh];
+    if (instances.empty()) {
+      continue;
+    }
+    const Object& object = meshes_[mesh];
+    glBindVertexArray(object.vao.Value());
+    EnableModelAttribute(model_location);
 
-  for(const auto[index, offset] : object_.usemtl) {
-    glBindTexture(GL_TEXTURE_2D, object_.textures[index].Value());
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(offset - prev_offset), GL_UNSIGNED_INT, reinterpret_cast<void*>(prev_offset * sizeof(GLuint)));
-    prev_offset = offset;
+    size_t prev_offset = 0;
+    for(const auto[index, offset] : object.usemtl) {
+      BeginGroupTimerQuery(static_cast<engine::MeshId>(mesh), index);
+      glBindTexture(GL_TEXTURE_2D, object.textures[index].Value());
+      for(const auto[first_instance, count] : instances) {
+        SetModelAttribute(model_location, first_instance);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(offset - prev_offset), GL_UNSIGNED_INT, reinterpret_cast<void*>(prev_offset * sizeof(GLuint)), static_cast<GLsizei>(count));
+        draw_stats_.drawn += count;
+      }
+      EndTimerQuery();
+      prev_offset = offset;
+    }
   }
-  glFinish();
+  glBindVertexArray(0);
 }
 
 } // namespace gl
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define BACKEND_GL_RENDERER_RENDERER_H_
 
 #include <string>
+#include <vector>
 
 #include <GL/glew.h>
 
@@ -9,31 +10,70 @@
 #include "backend/gl/renderer/object.h"
 #include "backend/gl/renderer/window.h"
 #include "backend/gl/renderer/uniform_updater.h"
-#include "engine/render/model.h"
 #include "engine/render/renderer.h"
+#include "engine/render/scene.h"
 
 namespace gl {
 
+// GL_TIME_ELAPSED queries of one frame, which cannot nest: the upload pass
+// first, then one per usemtl draw group.
+struct TimerFrame {
+  std::vector<ArrayObject> queries;
+  std::vector<engine::GpuGroupTime> groups;
+  bool issued;
+};
+
 class Renderer final : public engine::Renderer {
 public:
-  explicit Renderer(Window& window);
-  ~Renderer() override = default;
+  Renderer(Window& window, const engine::RendererOptions& options);
+  ~Renderer() override;
 
   void RenderFrame() override;
-  void LoadModel(const std::string& path) override;
-  [[nodiscard]] engine::Model& GetModel() noexcept override;
+  engine::MeshId LoadMesh(const std::string& path) override;
+  [[nodiscard]] engine::Scene& GetScene() noexcept override;
+  [[nodiscard]] engine::DrawStats GetDrawStats() const noexcept override;
+  [[nodiscard]] const engine::GpuTimings& GetGpuTimings() const noexcept override;
 private:
+  void WaitForFrame();
+  void DrawScene();
+  void ReadTimerQueries();
+  void BeginTimerQuery(size_t query);
+  void BeginGroupTimerQuery(engine::MeshId mesh, uint32_t material);
+  void EndTimerQuery();
+
   Window& window_;
   ValueObject program_;
   UniformUpdater uniform_updater_;
+  uint64_t uniforms_version_;
+  GLint model_location_;
+  ArrayObject instances_;
+
+  std::vector<std::vector<engine::InstanceRange>> mesh_instances_;
+  std::vector<Object> meshes_;
+  engine::DrawStats draw_stats_;
+
+  // One fence per frame in flight, bounding how far the CPU may run ahead of
+  // the GPU like the fences of the Vulkan backend.
+  std::vector<GLsync> frame_fences_;
+  size_t frame_fence_idx_;
 
-  Object object_;
+  std::vector<TimerFrame> timer_frames_;
+  uint64_t timed_frames_;
+  engine::GpuTimings gpu_timings_;
 
-  engine::Model model_;
+  engine::Scene scene_;
 };
 
-inline engine::Model& Renderer::GetModel() noexcept {
-  return model_;
+inline engine::Scene& Renderer::GetScene() noexcept {
+  return scene_;
+}
+
+inline engine::DrawStats Renderer::GetDrawStats() const noexcept {
+  return draw_stats_;
+}
+
+inline const engine::GpuTimings& Renderer::GetGpuTimings() const noexcept {
+  return gpu_timings_;
 }
 
 } // namespace gl
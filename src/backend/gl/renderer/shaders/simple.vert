@@ -1,6 +1,5 @@
 
 struct UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 };
@@ -8,6 +7,7 @@ struct UniformBufferObject {
 attribute vec3 inPosition;
 attribute vec3 inNormal;
 attribute vec2 inTexCoord;
+attribute mat4 inModel;
 
 varying vec2 fragTexCoord;
 varying vec3 fragNormal;
@@ -15,7 +15,7 @@ varying vec3 fragNormal;
 uniform UniformBufferObject ubo;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * ubo.view * inModel * vec4(inPosition, 1.0);
     fragTexCoord = inTexCoord;
     fragNormal = inNormal;
 }
\ No newline at end of file
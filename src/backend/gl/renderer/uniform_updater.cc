@@ -5,9 +5,8 @@
 namespace gl {
 
 void UniformUpdater::Update(const engine::Uniforms& uniforms) const  {
-  const auto& [model, view, proj] = uniforms;
+  const auto& [view, proj] = uniforms;
 
-  glUniformMatrix4fv(model_location_, 1, GL_FALSE, glm::value_ptr(model[0]));
   glUniformMatrix4fv(view_location_, 1, GL_FALSE, glm::value_ptr(view[0]));
   glUniformMatrix4fv(projection_location_, 1, GL_FALSE, glm::value_ptr(proj[0]));
 }
@@ -14,14 +14,12 @@ public:
 private:
   GLuint program_;
 
-  GLint model_location_;
   GLint view_location_;
   GLint projection_location_;
 };
 
 inline UniformUpdater::UniformUpdater(const GLuint program) noexcept
   : program_(program),
-    model_location_(glGetUniformLocation(program_, "ubo.model")),
     view_location_(glGetUniformLocation(program_, "ubo.view")),
     projection_location_(glGetUniformLocation(program_, "ubo.proj")) {}
 
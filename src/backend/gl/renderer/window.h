@@ -5,7 +5,12 @@
 
 namespace gl {
 
-class Window : public virtual engine::Window {};
+class Window : public virtual engine::Window {
+public:
+  // Returns false when the context rejects the interval, e.g. -1 for
+  // adaptive vsync without EXT_swap_control_tear.
+  virtual bool SetSwapInterval(int interval) noexcept = 0;
+};
 
 } // namespace gl
 
@@ -2,6 +2,8 @@
 
 #include <GLFW/glfw3.h>
 
+#include "trace/trace.h"
+
 namespace glfw::gl {
 
 Window::Window(const int width, const int height, const std::string& title)
@@ -21,8 +23,19 @@ void Window::SetWindowEventHandler(EventHandler* handler) noexcept {
   });
 }
 
+bool Window::SetSwapInterval(const int interval) noexcept {
+  // GLFW silently ignores negative intervals without tear control.
+  if (interval < 0 && glfwExtensionSupported("GLX_EXT_swap_control_tear") == GLFW_FALSE &&
+      glfwExtensionSupported("WGL_EXT_swap_control_tear") == GLFW_FALSE) {
+    return false;
+  }
+  glfwSwapInterval(interval);
+  return true;
+}
+
 void Window::Loop() const {
   internal::Window::Loop();
+  TRACE_ZONE("swap buffers");
   glfwSwapBuffers(window_);
 }
 
@@ -15,6 +15,7 @@ public:
 
   void Loop() const override;
   void SetWindowEventHandler(EventHandler* handler) noexcept override;
+  bool SetSwapInterval(int interval) noexcept override;
 };
 
 } // namespace glfw::gl
@@ -0,0 +1,22 @@
+#ifndef BACKEND_GL_WINDOW_HEADLESS_ERROR_H_
+#define BACKEND_GL_WINDOW_HEADLESS_ERROR_H_
+
+#include <stdexcept>
+#include <string>
+
+#include <EGL/egl.h>
+
+namespace headless::gl {
+
+struct Error final : std::runtime_error {
+  using runtime_error::runtime_error;
+
+  // Appends the calling thread's last EGL error.
+  [[nodiscard]] Error WithCode() const {
+    return Error{std::string(what()) + " [Code: " + std::to_string(eglGetError()) + ']'};
+  }
+};
+
+} // namespace headless::gl
+
+#endif // BACKEND_GL_WINDOW_HEADLESS_ERROR_H_
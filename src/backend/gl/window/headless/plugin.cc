@@ -0,0 +1,19 @@
+#include "engine/window/plugin.h"
+
+#include "backend/gl/window/headless/window.h"
+
+engine::Instance* ENGINE_CONV PluginCreateInstance() {
+  return new engine::Instance();
+}
+
+void ENGINE_CONV PluginDestroyInstance(engine::Instance* instance) {
+  delete instance;
+}
+
+engine::Window* ENGINE_CONV PluginCreateWindow(int width, int height, [[maybe_unused]] const std::string& title) {
+  return new headless::gl::Window(width, height);
+}
+
+void ENGINE_CONV PluginDestroyWindow(engine::Window* window) {
+  delete window;
+}
@@ -0,0 +1,114 @@
+#include "backend/gl/window/headless/window.h"
+
+#include <EGL/eglext.h>
+
+#include <cstring>
+
+#include "backend/gl/window/headless/error.h"
+#include "trace/trace.h"
+
+namespace headless::gl {
+
+namespace {
+
+// Prefers the surfaceless platform, which needs neither a display server
+// nor a GPU device node, over whatever the default display resolves to.
+EGLDisplay GetDisplay() {
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (client_extensions != nullptr && std::strstr(client_extensions, "EGL_MESA_platform_surfaceless") != nullptr) {
+    const auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display != nullptr) {
+      if (EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr); display != EGL_NO_DISPLAY) {
+        return display;
+      }
+    }
+  }
+#endif // EGL_PLATFORM_SURFACELESS_MESA
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY) {
+    throw Error("Failed to get EGL display").WithCode();
+  }
+  return display;
+}
+
+EGLConfig ChooseConfig(EGLDisplay display) {
+  constexpr EGLint config_attribs[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_ALPHA_SIZE, 8,
+    EGL_DEPTH_SIZE, 24,
+    EGL_NONE
+  };
+  EGLConfig config;
+  EGLint config_count = 0;
+  if (eglChooseConfig(display, config_attribs, &config, 1, &config_count) != EGL_TRUE) {
+    throw Error("Failed to choose EGL config").WithCode();
+  }
+  if (config_count == 0) {
+    throw Error("Failed to find EGL config with an OpenGL pbuffer");
+  }
+  return config;
+}
+
+} // namespace
+
+Window::Window(const int width, const int height)
+  : width_(width), height_(height), event_handler_(nullptr), display_(GetDisplay()), surface_(EGL_NO_SURFACE), context_(EGL_NO_CONTEXT) {
+  if (eglInitialize(display_, nullptr, nullptr) != EGL_TRUE) {
+    throw Error("Failed to initialize EGL display").WithCode();
+  }
+  try {
+    if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE) {
+      throw Error("Failed to bind OpenGL API").WithCode();
+    }
+    const EGLConfig config = ChooseConfig(display_);
+
+    const EGLint surface_attribs[] = {
+      EGL_WIDTH, width,
+      EGL_HEIGHT, height,
+      EGL_NONE
+    };
+    surface_ = eglCreatePbufferSurface(display_, config, surface_attribs);
+    if (surface_ == EGL_NO_SURFACE) {
+      throw Error("Failed to create EGL pbuffer surface").WithCode();
+    }
+    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, nullptr);
+    if (context_ == EGL_NO_CONTEXT) {
+      throw Error("Failed to create EGL context").WithCode();
+    }
+    if (eglMakeCurrent(display_, surface_, surface_, context_) != EGL_TRUE) {
+      throw Error("Failed to make EGL context current").WithCode();
+    }
+  } catch (...) {
+    // Terminating the display releases whatever was created on it, the
+    // destructor does not run.
+    eglTerminate(display_);
+    throw;
+  }
+  eglSwapInterval(display_, 1);
+}
+
+Window::~Window() {
+  eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglDestroyContext(display_, context_);
+  eglDestroySurface(display_, surface_);
+  eglTerminate(display_);
+}
+
+// Swapping a pbuffer presents nothing, but it still flushes the frame the
+// way a window swap would.
+void Window::Loop() const {
+  event_handler_->OnRenderEvent();
+  TRACE_ZONE("swap buffers");
+  eglSwapBuffers(display_, surface_);
+}
+
+bool Window::SetSwapInterval(const int interval) noexcept {
+  return eglSwapInterval(display_, interval) == EGL_TRUE;
+}
+
+} // namespace headless::gl
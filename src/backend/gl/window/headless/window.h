@@ -0,0 +1,73 @@
+#ifndef BACKEND_GL_WINDOW_HEADLESS_WINDOW_H_
+#define BACKEND_GL_WINDOW_HEADLESS_WINDOW_H_
+
+#include <EGL/egl.h>
+
+#include <string>
+
+#include "backend/gl/renderer/window.h"
+
+namespace headless::gl {
+
+// OpenGL context on an EGL pbuffer, created on Mesa's surfaceless platform
+// when available, so the GL renderer runs without a display, e.g. on
+// llvmpipe. It never closes by itself, the runner's frame limit ends the
+// loop.
+class Window final : public ::gl::Window {
+public:
+  Window(int width, int height);
+  ~Window() override;
+
+  Window(const Window& other) = delete;
+  Window& operator=(const Window& other) = delete;
+
+  [[nodiscard]] bool ShouldClose() const noexcept override;
+  [[nodiscard]] bool IsClosable() const noexcept override;
+  void Loop() const override;
+
+  void SetWindowTitle(const std::string& title) noexcept override;
+  void SetWindowEventHandler(EventHandler* handler) noexcept override;
+  void SetWindowResizedCallback(ResizeCallback resize_callback) noexcept override;
+
+  [[nodiscard]] int GetWidth() const noexcept override;
+  [[nodiscard]] int GetHeight() const noexcept override;
+
+  bool SetSwapInterval(int interval) noexcept override;
+private:
+  int width_;
+  int height_;
+  EventHandler* event_handler_;
+
+  EGLDisplay display_;
+  EGLSurface surface_;
+  EGLContext context_;
+};
+
+inline bool Window::ShouldClose() const noexcept {
+  return false;
+}
+
+inline bool Window::IsClosable() const noexcept {
+  return false;
+}
+
+inline void Window::SetWindowTitle([[maybe_unused]] const std::string& title) noexcept {}
+
+inline void Window::SetWindowEventHandler(EventHandler* handler) noexcept {
+  event_handler_ = handler;
+}
+
+// The pbuffer never changes size, so the callback is never invoked.
+inline void Window::SetWindowResizedCallback([[maybe_unused]] ResizeCallback resize_callback) noexcept {}
+
+inline int Window::GetWidth() const noexcept {
+  return width_;
+}
+
+inline int Window::GetHeight() const noexcept {
+  return height_;
+}
+
+} // namespace headless::gl
+
+#endif // BACKEND_GL_WINDOW_HEADLESS_WINDOW_H_
@@ -1,5 +1,7 @@
 #include "backend/gl/window/sdl/window.h"
 
+#include "trace/trace.h"
+
 namespace sdl::gl {
 
 Window::Window(const int width, const int height, const std::string& title)
@@ -10,9 +12,14 @@ Window::Window(const int width, const int height, const std::string& title)
 
 void Window::Loop() const noexcept {
   internal::Window::Loop();
+  TRACE_ZONE("swap buffers");
   SDL_GL_SwapWindow(window_);
 }
 
+bool Window::SetSwapInterval(const int interval) noexcept {
+  return SDL_GL_SetSwapInterval(interval) == 0;
+}
+
 void Window::OnWindowResize([[maybe_unused]]const int window_width, [[maybe_unused]]const int window_height) const {
   int width, height;
   SDL_GL_GetDrawableSize(window_, &width, &height);
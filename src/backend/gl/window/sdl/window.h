@@ -14,6 +14,7 @@ public:
   ~Window() override;
 
   void Loop() const noexcept override;
+  bool SetSwapInterval(int interval) noexcept override;
 protected:
   void OnWindowResize(int window_width, int window_height) const override;
 private:
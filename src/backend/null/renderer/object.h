@@ -0,0 +1,30 @@
+#ifndef BACKEND_NULL_RENDERER_OBJECT_H_
+#define BACKEND_NULL_RENDERER_OBJECT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "engine/render/types.h"
+#include "obj/types.h"
+
+namespace null {
+
+// Decoded RGBA pixels, kept so memory use matches a backend's staging copy.
+struct Texture {
+  uint32_t width;
+  uint32_t height;
+  std::vector<unsigned char> pixels;
+};
+
+// Everything a GPU backend would upload, left in host memory.
+struct Object {
+  std::vector<engine::Vertex> vertices;
+  std::vector<engine::Index> indices;
+
+  std::vector<Texture> textures;
+  std::vector<obj::UseMtl> usemtl;
+};
+
+} // namespace null
+
+#endif // BACKEND_NULL_RENDERER_OBJECT_H_
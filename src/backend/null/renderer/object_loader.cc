@@ -0,0 +1,74 @@
+#include "backend/null/renderer/object_loader.h"
+
+#include <memory>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "engine/render/data_util.h"
+#include "obj/parser.h"
+#include "trace/trace.h"
+
+namespace null {
+
+namespace {
+
+constexpr uint32_t kPixelSize = 4;
+
+Texture LoadDummyTexture() {
+  Texture texture = {};
+  texture.width = 1;
+  texture.height = 1;
+  texture.pixels.assign(kPixelSize, 0xff);
+  return texture;
+}
+
+Texture LoadTexture(const std::string& path) {
+  int image_width, image_height, image_channels;
+  std::unique_ptr<stbi_uc, void(*)(void*)> pixels(nullptr, stbi_image_free);
+  {
+    TRACE_ZONE("decode texture");
+    pixels.reset(stbi_load(path.c_str(), &image_width, &image_height, &image_channels, STBI_rgb_alpha));
+  }
+  if (pixels == nullptr) {
+    return LoadDummyTexture();
+  }
+  Texture texture = {};
+  texture.width = static_cast<uint32_t>(image_width);
+  texture.height = static_cast<uint32_t>(image_height);
+  texture.pixels.assign(pixels.get(), pixels.get() + kPixelSize * texture.width * texture.height);
+  return texture;
+}
+
+std::vector<Texture> LoadTextures(const obj::Data& data) {
+  std::vector<Texture> textures;
+  textures.reserve(data.mtl.size());
+
+  for(const obj::NewMtl& mtl : data.mtl) {
+    textures.push_back(LoadTexture(mtl.map_kd));
+  }
+  return textures;
+}
+
+} // namespace
+
+void ObjectLoader::Init() {
+  stbi_set_flip_vertically_on_load(true);
+}
+
+Object ObjectLoader::Load(const std::string& path) const {
+  TRACE_ZONE("ObjectLoader::Load");
+  obj::Data data = obj::ParseFromFile(path);
+
+  Object object = {};
+  object.vertices.resize(data.indices.size());
+  object.indices.resize(data.indices.size());
+  engine::data_util::RemoveDuplicates(data, object.vertices.data(), object.indices.data());
+
+  object.textures = LoadTextures(data);
+  object.usemtl = std::move(data.usemtl);
+
+  return object;
+}
+
+} // namespace null
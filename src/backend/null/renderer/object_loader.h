@@ -0,0 +1,23 @@
+#ifndef BACKEND_NULL_RENDERER_OBJECT_LOADER_H_
+#define BACKEND_NULL_RENDERER_OBJECT_LOADER_H_
+
+#include <string>
+
+#include "backend/null/renderer/object.h"
+
+namespace null {
+
+// Runs the same parse, dedupe and texture decode steps as the GPU backends.
+class ObjectLoader {
+public:
+  static void Init();
+
+  ObjectLoader() = default;
+  ~ObjectLoader() = default;
+
+  [[nodiscard]] Object Load(const std::string& path) const;
+};
+
+} // namespace null
+
+#endif // BACKEND_NULL_RENDERER_OBJECT_LOADER_H_
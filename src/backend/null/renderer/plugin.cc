@@ -0,0 +1,12 @@
+#include "engine/render/plugin.h"
+
+#include "backend/null/renderer/renderer.h"
+
+// Any window will do, nothing is ever drawn to it.
+engine::Renderer* ENGINE_CONV PluginCreateRenderer([[maybe_unused]] engine::Window& window, [[maybe_unused]] const engine::RendererOptions& options) {
+  return new null::Renderer();
+}
+
+void ENGINE_CONV PluginDestroyRenderer(engine::Renderer* renderer) {
+  delete renderer;
+}
@@ -0,0 +1,43 @@
+#include "backend/null/renderer/renderer.h"
+
+#include "backend/null/renderer/object_loader.h"
+#include "trace/trace.h"
+
+namespace null {
+
+Renderer::Renderer() : draw_stats_(), gpu_timings_() {
+  ObjectLoader::Init();
+}
+
+engine::MeshId Renderer::LoadMesh(const std::string& path) {
+  meshes_.push_back(ObjectLoader().Load(path));
+
+  return static_cast<engine::MeshId>(meshes_.size() - 1);
+}
+
+void Renderer::RenderFrame() {
+  TRACE_ZONE("Renderer::RenderFrame");
+  scene_.UpdateTransforms();
+  draw_stats_ = {};
+
+  transforms_.resize(scene_.GetObjectCount() + scene_.GetInstanceCount());
+  if (transforms_.empty()) {
+    return;
+  }
+  scene_.CopyTransforms(transforms_.data());
+
+  mesh_instances_.resize(meshes_.size());
+  scene_.CollectInstanceRanges(mesh_instances_);
+
+  // Counted the way the GL backend issues its draws, once per usemtl group
+  // and instance range.
+  for(size_t mesh = 0; mesh < meshes_.size(); ++mesh) {
+    for(size_t group = 0; group < meshes_[mesh].usemtl.size(); ++group) {
+      for(const engine::InstanceRange& range : mesh_instances_[mesh]) {
+        draw_stats_.drawn += range.instance_count;
+      }
+    }
+  }
+}
+
+} // namespace null
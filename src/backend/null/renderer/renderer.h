@@ -0,0 +1,53 @@
+#ifndef BACKEND_NULL_RENDERER_RENDERER_H_
+#define BACKEND_NULL_RENDERER_RENDERER_H_
+
+#include <string>
+#include <vector>
+
+#include "backend/null/renderer/object.h"
+#include "engine/render/renderer.h"
+#include "engine/render/scene.h"
+
+namespace null {
+
+// Renderer that never touches a graphics API. Meshes still go through the
+// whole load pipeline and each frame still does the CPU side of a draw:
+// transform updates, the instance copy and per-mesh batching. Profiling it
+// shows what the engine costs with drivers out of the picture.
+class Renderer final : public engine::Renderer {
+public:
+  Renderer();
+  ~Renderer() override = default;
+
+  void RenderFrame() override;
+  engine::MeshId LoadMesh(const std::string& path) override;
+  [[nodiscard]] engine::Scene& GetScene() noexcept override;
+  [[nodiscard]] engine::DrawStats GetDrawStats() const noexcept override;
+  // There is no GPU, so the timings stay zero.
+  [[nodiscard]] const engine::GpuTimings& GetGpuTimings() const noexcept override;
+private:
+  std::vector<Object> meshes_;
+  std::vector<std::vector<engine::InstanceRange>> mesh_instances_;
+  // Stands in for the mapped instance buffer.
+  std::vector<glm::mat4> transforms_;
+  engine::DrawStats draw_stats_;
+  engine::GpuTimings gpu_timings_;
+
+  engine::Scene scene_;
+};
+
+inline engine::Scene& Renderer::GetScene() noexcept {
+  return scene_;
+}
+
+inline engine::DrawStats Renderer::GetDrawStats() const noexcept {
+  return draw_stats_;
+}
+
+inline const engine::GpuTimings& Renderer::GetGpuTimings() const noexcept {
+  return gpu_timings_;
+}
+
+} // namespace null
+
+#endif // BACKEND_NULL_RENDERER_RENDERER_H_
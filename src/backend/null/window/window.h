@@ -0,0 +1,68 @@
+#ifndef BACKEND_NULL_WINDOW_WINDOW_H_
+#define BACKEND_NULL_WINDOW_WINDOW_H_
+
+#include <string>
+
+#include "engine/window/window.h"
+
+namespace null {
+
+// Window that only drives the render loop, paired with the null renderer.
+// Like the headless windows it never closes by itself, the runner's frame
+// limit ends the loop.
+class Window final : public engine::Window {
+public:
+  Window(int width, int height) noexcept;
+  ~Window() noexcept override = default;
+
+  [[nodiscard]] bool ShouldClose() const noexcept override;
+  [[nodiscard]] bool IsClosable() const noexcept override;
+  void Loop() const override;
+
+  void SetWindowTitle(const std::string& title) noexcept override;
+  void SetWindowEventHandler(EventHandler* handler) noexcept override;
+  void SetWindowResizedCallback(ResizeCallback resize_callback) noexcept override;
+
+  [[nodiscard]] int GetWidth() const noexcept override;
+  [[nodiscard]] int GetHeight() const noexcept override;
+private:
+  int width_;
+  int height_;
+  EventHandler* event_handler_;
+};
+
+inline Window::Window(const int width, const int height) noexcept
+  : width_(width), height_(height), event_handler_(nullptr) {}
+
+inline bool Window::ShouldClose() const noexcept {
+  return false;
+}
+
+inline bool Window::IsClosable() const noexcept {
+  return false;
+}
+
+inline void Window::Loop() const {
+  event_handler_->OnRenderEvent();
+}
+
+inline void Window::SetWindowTitle([[maybe_unused]] const std::string& title) noexcept {}
+
+inline void Window::SetWindowEventHandler(EventHandler* handler) noexcept {
+  event_handler_ = handler;
+}
+
+// The size never changes, so the callback is never invoked.
+inline void Window::SetWindowResizedCallback([[maybe_unused]] ResizeCallback resize_callback) noexcept {}
+
+inline int Window::GetWidth() const noexcept {
+  return width_;
+}
+
+inline int Window::GetHeight() const noexcept {
+  return height_;
+}
+
+} // namespace null
+
+#endif // BACKEND_NULL_WINDOW_WINDOW_H_
@@ -16,16 +16,16 @@ public:
     return memory_;
   }
 
-  [[nodiscard]] uint32_t size() const noexcept {
+  [[nodiscard]] VkDeviceSize size() const noexcept {
     return size_;
   }
 private:
   friend class Device;
 
   Memory memory_;
-  uint32_t size_;
+  VkDeviceSize size_;
 
-  explicit Buffer(DeviceHandle<VkBuffer>&& buffer, Memory&& memory, const uint32_t size) noexcept
+  explicit Buffer(DeviceHandle<VkBuffer>&& buffer, Memory&& memory, const VkDeviceSize size) noexcept
     : DeviceHandle<VkBuffer>(std::move(buffer)), memory_(std::move(memory)), size_(size) {}
 };
 
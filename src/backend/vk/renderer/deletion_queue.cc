@@ -0,0 +1,11 @@
+#include "backend/vk/renderer/deletion_queue.h"
+
+namespace vk {
+
+void DeletionQueue::Collect(const uint64_t completed_serial) noexcept {
+  while (!entries_.empty() && entries_.front().serial <= completed_serial) {
+    entries_.pop_front();
+  }
+}
+
+} // namespace vk
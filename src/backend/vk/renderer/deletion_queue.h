@@ -0,0 +1,57 @@
+#ifndef BACKEND_VK_RENDERER_DELETION_QUEUE_H_
+#define BACKEND_VK_RENDERER_DELETION_QUEUE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace vk {
+
+// Keeps replaced resources alive until the frames that may still use them
+// have completed. Frames are numbered by a serial that increases with every
+// submission, and a resource retired at serial n is destroyed once frame n
+// is known to be complete, so the device never has to be idled.
+class DeletionQueue {
+public:
+  DeletionQueue() noexcept;
+  ~DeletionQueue() = default;
+
+  DeletionQueue(const DeletionQueue& other) = delete;
+  DeletionQueue& operator=(const DeletionQueue& other) = delete;
+
+  // Serial of the latest submitted frame, which every retired resource is
+  // tagged with.
+  void SetSubmittedSerial(uint64_t serial) noexcept;
+
+  template<typename Resource>
+  void Push(Resource&& resource);
+
+  // Destroys every resource retired at or before the completed frame, in
+  // the order they were pushed.
+  void Collect(uint64_t completed_serial) noexcept;
+private:
+  struct Entry {
+    uint64_t serial;
+    std::shared_ptr<void> resource;
+  };
+
+  uint64_t submitted_serial_;
+  std::deque<Entry> entries_;
+};
+
+inline DeletionQueue::DeletionQueue() noexcept : submitted_serial_(0) {}
+
+inline void DeletionQueue::SetSubmittedSerial(const uint64_t serial) noexcept {
+  submitted_serial_ = serial;
+}
+
+template<typename Resource>
+void DeletionQueue::Push(Resource&& resource) {
+  entries_.push_back({submitted_serial_, std::make_shared<std::decay_t<Resource>>(std::forward<Resource>(resource))});
+}
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_DELETION_QUEUE_H_
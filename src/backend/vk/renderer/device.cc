@@ -21,12 +21,14 @@ VkSurfaceFormatKHR ChooseSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& av
   return available_formats[0];
 }
 
-VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR>& available_present_modes) {
-//  for (const auto& available_present_mode : available_present_modes) {
-//    if (available_present_mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-//      return available_present_mode;
-//    }
-//  }
+// Picks the first of the preferred modes the surface supports, falling back
+// to FIFO which every surface has to support.
+VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR>& available_present_modes, const std::vector<VkPresentModeKHR>& present_modes) {
+  for(const VkPresentModeKHR present_mode : present_modes) {
+    if (std::find(available_present_modes.begin(), available_present_modes.end(), present_mode) != available_present_modes.end()) {
+      return present_mode;
+    }
+  }
   return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -76,7 +78,7 @@ DeviceHandle<VkShaderModule> Device::CreateShaderModule(const std::vector<uint32
   return ExecuteCreate(vkCreateShaderModule, vkDestroyShaderModule, &create_info);
 }
 
-DeviceHandle<VkRenderPass> Device::CreateRenderPass(const VkFormat image_format, const VkFormat depth_format) const {
+DeviceHandle<VkRenderPass> Device::CreateRenderPass(const VkFormat image_format, const VkFormat depth_format, const VkAttachmentStoreOp depth_store_op, const VkImageLayout color_final_layout) const {
   VkAttachmentDescription color_attachment = {};
 
   color_attachment.format = image_format;
@@ -86,13 +88,13 @@ DeviceHandle<VkRenderPass> Device::CreateRenderPass(const VkFormat image_format,
   color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  color_attachment.finalLayout = color_final_layout;
 
   VkAttachmentDescription depth_attachment = {};
   depth_attachment.format = depth_format;
   depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
   depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-  depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depth_attachment.storeOp = depth_store_op;
   depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -134,16 +136,27 @@ DeviceHandle<VkRenderPass> Device::CreateRenderPass(const VkFormat image_format,
   return ExecuteCreate(vkCreateRenderPass, vkDestroyRenderPass, &render_pass_info);
 }
 
-DeviceHandle<VkPipelineLayout> Device::CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts) const {
+DeviceHandle<VkPipelineLayout> Device::CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges) const {
   VkPipelineLayoutCreateInfo pipeline_layout_info = {};
   pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
   pipeline_layout_info.setLayoutCount = descriptor_set_layouts.size();
   pipeline_layout_info.pSetLayouts = descriptor_set_layouts.data();
+  pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
+  pipeline_layout_info.pPushConstantRanges = push_constant_ranges.data();
 
   return ExecuteCreate(vkCreatePipelineLayout, vkDestroyPipelineLayout, &pipeline_layout_info);
 }
 
-DeviceHandle<VkPipeline> Device::CreatePipeline(VkPipelineLayout pipeline_layout, VkRenderPass render_pass, const std::vector<VkVertexInputAttributeDescription>& attribute_descriptions, const std::vector<VkVertexInputBindingDescription>& binding_descriptions, const std::vector<Shader>& shaders) const {
+PipelineCache Device::CreatePipelineCache(const std::vector<char>& initial_data) const {
+  VkPipelineCacheCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  create_info.initialDataSize = initial_data.size();
+  create_info.pInitialData = initial_data.data();
+
+  return PipelineCache(ExecuteCreate(vkCreatePipelineCache, vkDestroyPipelineCache, &create_info));
+}
+
+DeviceHandle<VkPipeline> Device::CreatePipeline(VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout, VkRenderPass render_pass, const std::vector<VkVertexInputAttributeDescription>& attribute_descriptions, const std::vector<VkVertexInputBindingDescription>& binding_descriptions, const std::vector<Shader>& shaders) const {
   std::vector<VkPipelineShaderStageCreateInfo> shader_stages_infos;
   shader_stages_infos.reserve(shaders.size());
   for(const auto& [module, description] : shaders) {
@@ -239,7 +252,7 @@ DeviceHandle<VkPipeline> Device::CreatePipeline(VkPipelineLayout pipeline_layout
   VkPipeline pipeline = VK_NULL_HANDLE;
   VkDevice logical_device = this->handle();
   const VkAllocationCallbacks* allocator = this->allocator();
-  if (const VkResult result = vkCreateGraphicsPipelines(logical_device, VK_NULL_HANDLE, 1, &pipeline_info, allocator, &pipeline); result != VK_SUCCESS) {
+  if (const VkResult result = vkCreateGraphicsPipelines(logical_device, pipeline_cache, 1, &pipeline_info, allocator, &pipeline); result != VK_SUCCESS) {
     throw Error("failed to create graphics pipeline").WithCode(result);
   }
   return {
@@ -250,6 +263,30 @@ DeviceHandle<VkPipeline> Device::CreatePipeline(VkPipelineLayout pipeline_layout
   };
 }
 
+DeviceHandle<VkPipeline> Device::CreateComputePipeline(VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout, const Shader& shader) const {
+  VkComputePipelineCreateInfo pipeline_info = {};
+  pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipeline_info.stage.stage = shader.description.stage;
+  pipeline_info.stage.pName = shader.description.entry_point.data();
+  pipeline_info.stage.module = shader.module.handle();
+  pipeline_info.layout = pipeline_layout;
+  pipeline_info.basePipelineHandle = VK_NULL_HANDLE;
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkDevice logical_device = this->handle();
+  const VkAllocationCallbacks* allocator = this->allocator();
+  if (const VkResult result = vkCreateComputePipelines(logical_device, pipeline_cache, 1, &pipeline_info, allocator, &pipeline); result != VK_SUCCESS) {
+    throw Error("failed to create compute pipeline").WithCode(result);
+  }
+  return {
+    pipeline,
+    logical_device,
+    vkDestroyPipeline,
+    allocator
+  };
+}
+
 DeviceHandle<VkCommandPool> Device::CreateCommandPool() const {
   VkCommandPoolCreateInfo create_info = {};
   create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -274,6 +311,15 @@ DeviceHandle<VkFence> Device::CreateFence() const {
   return ExecuteCreate(vkCreateFence, vkDestroyFence, &create_info);
 }
 
+DeviceHandle<VkQueryPool> Device::CreateQueryPool(const VkQueryType type, const uint32_t count) const {
+  VkQueryPoolCreateInfo create_info = {};
+  create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  create_info.queryType = type;
+  create_info.queryCount = count;
+
+  return ExecuteCreate(vkCreateQueryPool, vkDestroyQueryPool, &create_info);
+}
+
 DeviceHandle<VkDescriptorSetLayout> Device::CreateUniformDescriptorSetLayout() const {
   VkDescriptorSetLayoutBinding layout_binding = {};
   layout_binding.binding = 0;
@@ -290,10 +336,10 @@ DeviceHandle<VkDescriptorSetLayout> Device::CreateUniformDescriptorSetLayout() c
   return ExecuteCreate(vkCreateDescriptorSetLayout, vkDestroyDescriptorSetLayout, &layout_info);
 }
 
-DeviceHandle<VkDescriptorSetLayout> Device::CreateSamplerDescriptorSetLayout() const {
+DeviceHandle<VkDescriptorSetLayout> Device::CreateSamplerDescriptorSetLayout(const uint32_t descriptor_count, const VkDescriptorBindingFlagsEXT binding_flags) const {
   VkDescriptorSetLayoutBinding sampler_layout_binding = {};
   sampler_layout_binding.binding = 0;
-  sampler_layout_binding.descriptorCount = 1;
+  sampler_layout_binding.descriptorCount = descriptor_count;
   sampler_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
   sampler_layout_binding.pImmutableSamplers = nullptr;
   sampler_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -303,34 +349,58 @@ DeviceHandle<VkDescriptorSetLayout> Device::CreateSamplerDescriptorSetLayout() c
   layout_info.bindingCount = 1;
   layout_info.pBindings = &sampler_layout_binding;
 
+  VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_info = {};
+  binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+  binding_flags_info.bindingCount = 1;
+  binding_flags_info.pBindingFlags = &binding_flags;
+  if (binding_flags != 0) {
+    layout_info.pNext = &binding_flags_info;
+  }
+
+  return ExecuteCreate(vkCreateDescriptorSetLayout, vkDestroyDescriptorSetLayout, &layout_info);
+}
+
+DeviceHandle<VkDescriptorSetLayout> Device::CreateDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings) const {
+  VkDescriptorSetLayoutCreateInfo layout_info = {};
+  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+  layout_info.pBindings = bindings.data();
+
   return ExecuteCreate(vkCreateDescriptorSetLayout, vkDestroyDescriptorSetLayout, &layout_info);
 }
 
-DeviceHandle<VkDescriptorPool> Device::CreateDescriptorPool(const size_t uniform_count, const size_t sampler_count) const {
-  std::array<VkDescriptorPoolSize, 2> pool_sizes = {};
-  pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-  pool_sizes[0].descriptorCount = static_cast<uint32_t>(uniform_count);
+DeviceHandle<VkDescriptorPool> Device::CreateDescriptorPool(const VkDescriptorType type, const size_t count) const {
+  VkDescriptorPoolSize pool_size = {};
+  pool_size.type = type;
+  pool_size.descriptorCount = static_cast<uint32_t>(count);
 
-  pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-  pool_sizes[1].descriptorCount = static_cast<uint32_t>(sampler_count);
+  VkDescriptorPoolCreateInfo pool_info = {};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.poolSizeCount = 1;
+  pool_info.pPoolSizes = &pool_size;
+  pool_info.maxSets = static_cast<uint32_t>(count);
 
+  return ExecuteCreate(vkCreateDescriptorPool, vkDestroyDescriptorPool, &pool_info);
+}
+
+DeviceHandle<VkDescriptorPool> Device::CreateDescriptorPool(const std::vector<VkDescriptorPoolSize>& pool_sizes, const size_t max_sets) const {
   VkDescriptorPoolCreateInfo pool_info = {};
   pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
   pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
   pool_info.pPoolSizes = pool_sizes.data();
-  pool_info.maxSets = static_cast<uint32_t>(uniform_count + sampler_count);
+  pool_info.maxSets = static_cast<uint32_t>(max_sets);
 
   return ExecuteCreate(vkCreateDescriptorPool, vkDestroyDescriptorPool, &pool_info);
 }
 
-DeviceHandle<VkImageView> Device::CreateImageView(VkImage image, const VkImageAspectFlags aspect_flags, const VkFormat format, const uint32_t mip_levels) const {
+DeviceHandle<VkImageView> Device::CreateImageView(VkImage image, const VkImageAspectFlags aspect_flags, const VkFormat format, const uint32_t mip_levels, const uint32_t base_mip_level) const {
   VkImageViewCreateInfo view_info = {};
   view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
   view_info.image = image;
   view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
   view_info.format = format;
   view_info.subresourceRange.aspectMask = aspect_flags;
-  view_info.subresourceRange.baseMipLevel = 0;
+  view_info.subresourceRange.baseMipLevel = base_mip_level;
   view_info.subresourceRange.levelCount = mip_levels;
   view_info.subresourceRange.baseArrayLayer = 0;
   view_info.subresourceRange.layerCount = 1;
@@ -388,11 +458,11 @@ std::vector<VkDescriptorSet> Device::CreateDescriptorSets(VkDescriptorSetLayout
   return ExecuteAllocate(vkAllocateDescriptorSets, count, &alloc_info);
 }
 
-std::vector<VkCommandBuffer> Device::CreateCommandBuffers(VkCommandPool cmd_pool, const uint32_t count) const {
+std::vector<VkCommandBuffer> Device::CreateCommandBuffers(VkCommandPool cmd_pool, const uint32_t count, const VkCommandBufferLevel level) const {
   VkCommandBufferAllocateInfo alloc_info = {};
   alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
   alloc_info.commandPool = cmd_pool;
-  alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  alloc_info.level = level;
   alloc_info.commandBufferCount = count;
 
   return ExecuteAllocate(vkAllocateCommandBuffers, count, &alloc_info);
@@ -407,7 +477,7 @@ Memory Device::CreateMemory(const VkMemoryPropertyFlags properties, const VkMemo
   return Memory(ExecuteCreate(vkAllocateMemory, vkFreeMemory, &alloc_info));
 }
 
-Buffer Device::CreateBuffer(const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, const uint32_t data_size) const {
+Buffer Device::CreateBuffer(const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, const VkDeviceSize data_size) const {
   VkBufferCreateInfo buffer_info = {};
   buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   buffer_info.size = data_size;
@@ -465,15 +535,21 @@ Image Device::CreateImage(const VkImageUsageFlags usage, const VkMemoryPropertyF
   );
 }
 
-Swapchain Device::CreateSwapchain(const VkExtent2D size, VkSurfaceKHR surface) const {
+// An image count of zero requests one more image than the surface minimum.
+// Passing the swapchain being replaced lets the presentation engine hand its
+// resources over; the old swapchain is retired but must still be destroyed.
+Swapchain Device::CreateSwapchain(const VkExtent2D size, VkSurfaceKHR surface, const std::vector<VkPresentModeKHR>& present_modes, uint32_t image_count, VkSwapchainKHR old_swapchain) const {
   const SurfaceSupportDetails surface_support = physical_device_.GetSurfaceSupportDetails(surface);
 
   const auto[format, colorSpace] = ChooseSurfaceFormat(surface_support.formats);
-  const VkPresentModeKHR present_mode = ChoosePresentMode(surface_support.present_modes);
+  const VkPresentModeKHR present_mode = ChoosePresentMode(surface_support.present_modes, present_modes);
 
   const VkExtent2D extent = ChooseExtent(size, surface_support.capabilities);
 
-  uint32_t image_count = surface_support.capabilities.minImageCount + 1;
+  if (image_count == 0) {
+    image_count = surface_support.capabilities.minImageCount + 1;
+  }
+  image_count = std::max(image_count, surface_support.capabilities.minImageCount);
   if (surface_support.capabilities.maxImageCount > 0 && image_count > surface_support.capabilities.maxImageCount) {
     image_count = surface_support.capabilities.maxImageCount;
   }
@@ -502,6 +578,7 @@ Swapchain Device::CreateSwapchain(const VkExtent2D size, VkSurfaceKHR surface) c
   create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
   create_info.presentMode = present_mode;
   create_info.clipped = VK_TRUE;
+  create_info.oldSwapchain = old_swapchain;
 
   return Swapchain(
     ExecuteCreate(vkCreateSwapchainKHR, vkDestroySwapchainKHR, &create_info),
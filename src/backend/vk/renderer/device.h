@@ -9,6 +9,7 @@
 #include "backend/vk/renderer/handle.h"
 #include "backend/vk/renderer/image.h"
 #include "backend/vk/renderer/physical_device.h"
+#include "backend/vk/renderer/pipeline_cache.h"
 #include "backend/vk/renderer/shader.h"
 #include "backend/vk/renderer/swapchain.h"
 
@@ -29,24 +30,29 @@ public:
   [[nodiscard]] const Queue& present_queue() const noexcept;
 
   [[nodiscard]] DeviceHandle<VkShaderModule> CreateShaderModule(const std::vector<uint32_t>& shader_info) const;
-  [[nodiscard]] DeviceHandle<VkRenderPass> CreateRenderPass(VkFormat image_format, VkFormat depth_format) const;
-  [[nodiscard]] DeviceHandle<VkPipelineLayout> CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts) const;
-  [[nodiscard]] DeviceHandle<VkPipeline> CreatePipeline(VkPipelineLayout pipeline_layout, VkRenderPass render_pass, const std::vector<VkVertexInputAttributeDescription>& attribute_descriptions, const std::vector<VkVertexInputBindingDescription>& binding_descriptions, const std::vector<Shader>& shaders) const;
+  [[nodiscard]] DeviceHandle<VkRenderPass> CreateRenderPass(VkFormat image_format, VkFormat depth_format, VkAttachmentStoreOp depth_store_op = VK_ATTACHMENT_STORE_OP_DONT_CARE, VkImageLayout color_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) const;
+  [[nodiscard]] DeviceHandle<VkPipelineLayout> CreatePipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptor_set_layouts, const std::vector<VkPushConstantRange>& push_constant_ranges) const;
+  [[nodiscard]] PipelineCache CreatePipelineCache(const std::vector<char>& initial_data) const;
+  [[nodiscard]] DeviceHandle<VkPipeline> CreatePipeline(VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout, VkRenderPass render_pass, const std::vector<VkVertexInputAttributeDescription>& attribute_descriptions, const std::vector<VkVertexInputBindingDescription>& binding_descriptions, const std::vector<Shader>& shaders) const;
+  [[nodiscard]] DeviceHandle<VkPipeline> CreateComputePipeline(VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout, const Shader& shader) const;
   [[nodiscard]] DeviceHandle<VkCommandPool> CreateCommandPool() const;
   [[nodiscard]] DeviceHandle<VkSemaphore> CreateSemaphore() const;
   [[nodiscard]] DeviceHandle<VkFence> CreateFence() const;
+  [[nodiscard]] DeviceHandle<VkQueryPool> CreateQueryPool(VkQueryType type, uint32_t count) const;
   [[nodiscard]] DeviceHandle<VkDescriptorSetLayout> CreateUniformDescriptorSetLayout() const;
-  [[nodiscard]] DeviceHandle<VkDescriptorSetLayout> CreateSamplerDescriptorSetLayout() const;
-  [[nodiscard]] DeviceHandle<VkDescriptorPool> CreateDescriptorPool(size_t uniform_count, size_t sampler_count) const;
-  [[nodiscard]] DeviceHandle<VkImageView> CreateImageView(VkImage image, VkImageAspectFlags aspect_flags, VkFormat format, uint32_t mip_levels = 1) const;
+  [[nodiscard]] DeviceHandle<VkDescriptorSetLayout> CreateSamplerDescriptorSetLayout(uint32_t descriptor_count = 1, VkDescriptorBindingFlagsEXT binding_flags = 0) const;
+  [[nodiscard]] DeviceHandle<VkDescriptorSetLayout> CreateDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings) const;
+  [[nodiscard]] DeviceHandle<VkDescriptorPool> CreateDescriptorPool(VkDescriptorType type, size_t count) const;
+  [[nodiscard]] DeviceHandle<VkDescriptorPool> CreateDescriptorPool(const std::vector<VkDescriptorPoolSize>& pool_sizes, size_t max_sets) const;
+  [[nodiscard]] DeviceHandle<VkImageView> CreateImageView(VkImage image, VkImageAspectFlags aspect_flags, VkFormat format, uint32_t mip_levels = 1, uint32_t base_mip_level = 0) const;
   [[nodiscard]] DeviceHandle<VkFramebuffer> CreateFramebuffer(const std::vector<VkImageView>& views, VkRenderPass render_pass, VkExtent2D extent) const;
   [[nodiscard]] DeviceHandle<VkSampler> CreateSampler(VkSamplerMipmapMode mipmap_mode, uint32_t mip_levels) const;
 
   [[nodiscard]] std::vector<VkDescriptorSet> CreateDescriptorSets(VkDescriptorSetLayout descriptor_set_layout, VkDescriptorPool descriptor_pool, size_t count) const;
-  [[nodiscard]] std::vector<VkCommandBuffer> CreateCommandBuffers(VkCommandPool cmd_pool, uint32_t count) const;
+  [[nodiscard]] std::vector<VkCommandBuffer> CreateCommandBuffers(VkCommandPool cmd_pool, uint32_t count, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) const;
 
   [[nodiscard]] Memory CreateMemory(VkMemoryPropertyFlags properties, VkMemoryRequirements mem_requirements) const;
-  [[nodiscard]] Buffer CreateBuffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, uint32_t data_size) const;
+  [[nodiscard]] Buffer CreateBuffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceSize data_size) const;
   [[nodiscard]] Image CreateImage(VkImageUsageFlags usage,
                                   VkMemoryPropertyFlags properties,
                                   VkImageAspectFlags aspect_flags,
@@ -54,7 +60,7 @@ public:
                                   VkFormat format,
                                   VkImageTiling tiling,
                                   uint32_t mip_levels = 1) const;
-  [[nodiscard]] Swapchain CreateSwapchain(VkExtent2D size, VkSurfaceKHR surface) const;
+  [[nodiscard]] Swapchain CreateSwapchain(VkExtent2D size, VkSurfaceKHR surface, const std::vector<VkPresentModeKHR>& present_modes, uint32_t image_count = 0, VkSwapchainKHR old_swapchain = VK_NULL_HANDLE) const;
 private:
   friend class DeviceSelector;
 
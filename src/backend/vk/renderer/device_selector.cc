@@ -24,7 +24,7 @@ std::pair<bool, QueueFamilyIndices> DeviceIsSuitable(const PhysicalDevice& physi
     if (queue_family_props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
       graphic = static_cast<uint32_t>(i);
     }
-    if (physical_device.CheckSurfaceSupported(requirements.surface, i)) {
+    if (requirements.present && physical_device.CheckSurfaceSupported(requirements.surface, i)) {
       present = static_cast<uint32_t>(i);
     }
     if ((requirements.graphic && !graphic.has_value()) ||
@@ -36,6 +36,10 @@ std::pair<bool, QueueFamilyIndices> DeviceIsSuitable(const PhysicalDevice& physi
         !physical_device.CheckExtensionsSupport(requirements.extensions)) {
       continue;
     }
+    // Without a surface nothing is presented, the graphics queue stands in.
+    if (!requirements.present) {
+      return {true, {graphic.value(), graphic.value()}};
+    }
     const SurfaceSupportDetails support_details = physical_device.GetSurfaceSupportDetails(requirements.surface);
     if (!support_details.formats.empty() && !support_details.present_modes.empty()) {
       return {true, {graphic.value(), present.value()}};
@@ -44,7 +48,7 @@ std::pair<bool, QueueFamilyIndices> DeviceIsSuitable(const PhysicalDevice& physi
   return {};
 }
 
-Handle<VkDevice> CreateDevice(VkPhysicalDevice physical_device, const QueueFamilyIndices& indices, const std::vector<const char*>& extensions, const std::vector<const char*>& layers, const VkAllocationCallbacks* allocator) {
+Handle<VkDevice> CreateDevice(const PhysicalDevice& physical_device, const QueueFamilyIndices& indices, const std::vector<const char*>& extensions, const std::vector<const char*>& layers, const VkAllocationCallbacks* allocator) {
   std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
   std::set unique_family_ids = {
     indices.graphic,
@@ -59,16 +63,41 @@ Handle<VkDevice> CreateDevice(VkPhysicalDevice physical_device, const QueueFamil
     queue_create_info.pQueuePriorities = &queue_priority;
     queue_create_infos.push_back(queue_create_info);
   }
+  const VkPhysicalDeviceFeatures supported_features = physical_device.GetFeatures();
+
   VkPhysicalDeviceFeatures device_features = {};
   device_features.samplerAnisotropy = VK_TRUE;
+  device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+  device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+
+  std::vector<const char*> device_extensions = extensions;
+
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features = {};
+  indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+  const bool descriptor_indexing = physical_device.CheckDescriptorIndexingSupported();
+  if (descriptor_indexing) {
+    indexing_features.runtimeDescriptorArray = VK_TRUE;
+    indexing_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+    indexing_features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    device_extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+    device_extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+  }
+  if (physical_device.CheckDrawIndirectCountSupported()) {
+    device_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+  }
 
   VkDeviceCreateInfo create_info = {};
   create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
   create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
   create_info.pQueueCreateInfos = queue_create_infos.data();
   create_info.pEnabledFeatures = &device_features;
-  create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
-  create_info.ppEnabledExtensionNames = extensions.data();
+  create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
+  create_info.ppEnabledExtensionNames = device_extensions.data();
+  if (descriptor_indexing) {
+    create_info.pNext = &indexing_features;
+  }
   if (!layers.empty()) {
     create_info.enabledLayerCount = static_cast<uint32_t>(layers.size());
     create_info.ppEnabledLayerNames = layers.data();
@@ -76,7 +105,7 @@ Handle<VkDevice> CreateDevice(VkPhysicalDevice physical_device, const QueueFamil
   create_info.enabledLayerCount = 0;
 
   VkDevice logical_device = VK_NULL_HANDLE;
-  if (const VkResult result = vkCreateDevice(physical_device, &create_info, allocator, &logical_device); result != VK_SUCCESS) {
+  if (const VkResult result = vkCreateDevice(physical_device.handle(), &create_info, allocator, &logical_device); result != VK_SUCCESS) {
     throw Error("failed to create logical device").WithCode(result);
   }
   return {
@@ -92,7 +121,7 @@ std::optional<Device> DeviceSelector::Select(const Requirements& requirements) c
   for(VkPhysicalDevice vk_physical_device : physical_devices_) {
     PhysicalDevice physical_device(vk_physical_device);
     if (auto[suitable, indices] = DeviceIsSuitable(physical_device, requirements); suitable) {
-      Handle<VkDevice> device = CreateDevice(vk_physical_device, indices, requirements.extensions, requirements.layers, requirements.allocator);
+      Handle<VkDevice> device = CreateDevice(physical_device, indices, requirements.extensions, requirements.layers, requirements.allocator);
 
       Queue graphics_queue = {};
       vkGetDeviceQueue(device.handle(), indices.graphic, 0, &graphics_queue.handle);
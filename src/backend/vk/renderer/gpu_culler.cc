@@ -0,0 +1,440 @@
+#include "backend/vk/renderer/gpu_culler.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+
+#include "backend/vk/renderer/error.h"
+#include "backend/vk/renderer/shader.h"
+
+namespace vk {
+
+namespace {
+
+constexpr uint32_t kCullGroupSize = 64;
+constexpr uint32_t kPyramidGroupSize = 8;
+constexpr VkFormat kDepthFormat = VK_FORMAT_D32_SFLOAT;
+constexpr VkFormat kPyramidFormat = VK_FORMAT_R32_SFLOAT;
+constexpr uint32_t kDrawCommandStride = sizeof(VkDrawIndexedIndirectCommand);
+
+struct CullConstants {
+  glm::mat4 view_proj;
+  glm::ivec2 pyramid_size;
+  uint32_t pyramid_levels;
+  uint32_t item_count;
+};
+
+struct PyramidConstants {
+  glm::ivec2 input_size;
+  glm::ivec2 output_size;
+};
+
+inline uint32_t PreviousPowerOfTwo(const uint32_t value) noexcept {
+  uint32_t power = 1;
+  while (power <= value / 2) {
+    power *= 2;
+  }
+  return power;
+}
+
+inline uint32_t GroupCount(const uint32_t count, const uint32_t group_size) noexcept {
+  return (count + group_size - 1) / group_size;
+}
+
+// Grows a per-frame buffer to hold at least size bytes and maps it when
+// mapped is not null. Only called for a frame whose fence has been waited on.
+// Returns whether the buffer was reallocated.
+bool ReserveBuffer(const Device& device, Buffer& buffer, void** mapped, const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties, const VkDeviceSize size) {
+  if (buffer.handle() != VK_NULL_HANDLE && buffer.size() >= size) {
+    return false;
+  }
+  const VkDeviceSize capacity = std::max<VkDeviceSize>(size, 2 * buffer.size());
+  buffer = device.CreateBuffer(usage, properties, capacity);
+  if (mapped != nullptr) {
+    *mapped = buffer.memory().Map();
+  }
+  return true;
+}
+
+VkDescriptorSetLayoutBinding CreateComputeBinding(const uint32_t binding, const VkDescriptorType type) noexcept {
+  VkDescriptorSetLayoutBinding layout_binding = {};
+  layout_binding.binding = binding;
+  layout_binding.descriptorCount = 1;
+  layout_binding.descriptorType = type;
+  layout_binding.pImmutableSamplers = nullptr;
+  layout_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+  return layout_binding;
+}
+
+VkPushConstantRange CreateComputePushConstantRange(const uint32_t size) noexcept {
+  VkPushConstantRange push_constant_range = {};
+  push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  push_constant_range.offset = 0;
+  push_constant_range.size = size;
+
+  return push_constant_range;
+}
+
+DeviceHandle<VkPipeline> CreateComputePipeline(const Device& device, VkPipelineCache pipeline_cache, VkPipelineLayout pipeline_layout, const ComputeShader compute_shader) {
+  const auto[description, spirv] = Shader::GetComputeInfo(compute_shader);
+
+  Shader shader = {};
+  shader.module = device.CreateShaderModule(spirv);
+  shader.description = description;
+
+  return device.CreateComputePipeline(pipeline_cache, pipeline_layout, shader);
+}
+
+VkImageMemoryBarrier CreateImageBarrier(VkImage image, const VkImageAspectFlags aspect_flags, const VkImageLayout old_layout, const VkImageLayout new_layout) noexcept {
+  VkImageMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = old_layout;
+  barrier.newLayout = new_layout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = aspect_flags;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  return barrier;
+}
+
+void RecordMemoryBarrier(VkCommandBuffer cmd_buffer,
+                         const VkPipelineStageFlags src_stage, const VkAccessFlags src_access,
+                         const VkPipelineStageFlags dst_stage, const VkAccessFlags dst_access) noexcept {
+  VkMemoryBarrier barrier = {};
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = src_access;
+  barrier.dstAccessMask = dst_access;
+
+  vkCmdPipelineBarrier(cmd_buffer, src_stage, dst_stage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+} // namespace
+
+bool GpuCuller::IsSupported(const PhysicalDevice& physical_device) {
+  return physical_device.CheckDrawIndirectCountSupported() &&
+         physical_device.CheckFormatFeatureSupported(kDepthFormat, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) &&
+         physical_device.CheckFormatFeatureSupported(kDepthFormat, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) &&
+         physical_device.CheckFormatFeatureSupported(kPyramidFormat, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+}
+
+GpuCuller::GpuCuller(const Device& device, VkPipelineCache pipeline_cache, const size_t frame_count)
+  : device_(&device),
+    draw_indexed_indirect_count_(reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(device.handle(), "vkCmdDrawIndexedIndirectCountKHR"))),
+    pyramid_ready_(false),
+    last_view_proj_(1.0f),
+    stats_() {
+  if (draw_indexed_indirect_count_ == nullptr) {
+    throw Error("failed to load vkCmdDrawIndexedIndirectCountKHR");
+  }
+  cull_layout_ = device.CreateDescriptorSetLayout({
+    CreateComputeBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+    CreateComputeBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+    CreateComputeBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+    CreateComputeBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+    CreateComputeBinding(4, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE),
+    CreateComputeBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+  });
+  cull_pipeline_layout_ = device.CreatePipelineLayout({cull_layout_.handle()}, {CreateComputePushConstantRange(sizeof(CullConstants))});
+  cull_pipeline_ = CreateComputePipeline(device, pipeline_cache, cull_pipeline_layout_.handle(), ComputeShader::kCull);
+
+  VkDescriptorPoolSize buffers_pool_size = {};
+  buffers_pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  buffers_pool_size.descriptorCount = static_cast<uint32_t>(5 * frame_count);
+
+  VkDescriptorPoolSize images_pool_size = {};
+  images_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  images_pool_size.descriptorCount = static_cast<uint32_t>(frame_count);
+
+  cull_descriptor_pool_ = device.CreateDescriptorPool({buffers_pool_size, images_pool_size}, frame_count);
+  const std::vector<VkDescriptorSet> descriptor_sets = device.CreateDescriptorSets(cull_layout_.handle(), cull_descriptor_pool_.handle(), frame_count);
+
+  frames_.resize(frame_count);
+  for(size_t i = 0; i < frame_count; ++i) {
+    frames_[i].descriptor_set = descriptor_sets[i];
+    frames_[i].pyramid_view_proj = device.CreateBuffer(
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      sizeof(glm::mat4)
+    );
+    frames_[i].mapped_pyramid_view_proj = frames_[i].pyramid_view_proj.memory().Map();
+  }
+
+  pyramid_layout_ = device.CreateDescriptorSetLayout({
+    CreateComputeBinding(0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE),
+    CreateComputeBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+  });
+  pyramid_pipeline_layout_ = device.CreatePipelineLayout({pyramid_layout_.handle()}, {CreateComputePushConstantRange(sizeof(PyramidConstants))});
+  pyramid_pipeline_ = CreateComputePipeline(device, pipeline_cache, pyramid_pipeline_layout_.handle(), ComputeShader::kDepthPyramid);
+}
+
+void GpuCuller::SetDepthImage(const Image& depth_image, DeletionQueue& deletion_queue) {
+  if (pyramid_.handle() != VK_NULL_HANDLE) {
+    deletion_queue.Push(std::move(pyramid_levels_));
+    deletion_queue.Push(std::move(pyramid_descriptor_pool_));
+    deletion_queue.Push(std::move(pyramid_));
+  }
+  const VkExtent2D depth_extent = depth_image.extent();
+  const VkExtent2D extent = {PreviousPowerOfTwo(depth_extent.width), PreviousPowerOfTwo(depth_extent.height)};
+
+  uint32_t mip_levels = 1;
+  while ((std::max(extent.width, extent.height) >> mip_levels) != 0) {
+    ++mip_levels;
+  }
+  pyramid_levels_.clear();
+  pyramid_ = device_->CreateImage(
+    VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    VK_IMAGE_ASPECT_COLOR_BIT,
+    extent,
+    kPyramidFormat,
+    VK_IMAGE_TILING_OPTIMAL,
+    mip_levels
+  );
+
+  VkDescriptorPoolSize sampled_pool_size = {};
+  sampled_pool_size.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  sampled_pool_size.descriptorCount = mip_levels;
+
+  VkDescriptorPoolSize storage_pool_size = {};
+  storage_pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  storage_pool_size.descriptorCount = mip_levels;
+
+  pyramid_descriptor_pool_ = device_->CreateDescriptorPool({sampled_pool_size, storage_pool_size}, mip_levels);
+  const std::vector<VkDescriptorSet> descriptor_sets = device_->CreateDescriptorSets(pyramid_layout_.handle(), pyramid_descriptor_pool_.handle(), mip_levels);
+
+  pyramid_levels_.reserve(mip_levels);
+  for(uint32_t i = 0; i < mip_levels; ++i) {
+    DepthPyramidLevel level = {};
+    level.view = device_->CreateImageView(pyramid_.handle(), VK_IMAGE_ASPECT_COLOR_BIT, kPyramidFormat, 1, i);
+    level.descriptor_set = descriptor_sets[i];
+    level.input_extent = i == 0 ? depth_extent : pyramid_levels_[i - 1].extent;
+    level.extent = {std::max(extent.width >> i, 1u), std::max(extent.height >> i, 1u)};
+
+    // The first level reads the depth image, every other one the level above.
+    VkDescriptorImageInfo input_info = {};
+    input_info.imageView = i == 0 ? depth_image.view() : pyramid_levels_[i - 1].view.handle();
+    input_info.imageLayout = i == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+    VkDescriptorImageInfo output_info = {};
+    output_info.imageView = level.view.handle();
+    output_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    std::array<VkWriteDescriptorSet, 2> descriptor_writes = {};
+    descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[0].dstSet = level.descriptor_set;
+    descriptor_writes[0].dstBinding = 0;
+    descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptor_writes[0].descriptorCount = 1;
+    descriptor_writes[0].pImageInfo = &input_info;
+
+    descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[1].dstSet = level.descriptor_set;
+    descriptor_writes[1].dstBinding = 1;
+    descriptor_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    descriptor_writes[1].descriptorCount = 1;
+    descriptor_writes[1].pImageInfo = &output_info;
+
+    vkUpdateDescriptorSets(device_->handle(), static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
+
+    pyramid_levels_.emplace_back(std::move(level));
+  }
+  pyramid_ready_ = false;
+  for(CullFrame& cull_frame : frames_) {
+    cull_frame.descriptors_dirty = true;
+  }
+}
+
+bool GpuCuller::Prepare(const size_t frame, const std::vector<CullItem>& items, const uint64_t items_version, const uint32_t batch_count,
+                        const Buffer& transforms, const glm::mat4& view_proj) {
+  CullFrame& cull_frame = frames_[frame];
+  // Written per frame rather than pushed, so cached command buffers stay
+  // valid when only the camera moves.
+  std::memcpy(cull_frame.mapped_pyramid_view_proj, &last_view_proj_, sizeof(glm::mat4));
+  last_view_proj_ = view_proj;
+
+  // The fence of this frame has been waited on, so its counts are final.
+  uint32_t drawn = 0;
+  if (cull_frame.batch_count != 0) {
+    const auto counts = static_cast<const uint32_t*>(cull_frame.mapped_counts);
+    drawn = std::accumulate(counts, counts + cull_frame.batch_count, 0u);
+  }
+  stats_ = {drawn, cull_frame.item_count - drawn};
+  cull_frame.item_count = static_cast<uint32_t>(items.size());
+  cull_frame.batch_count = batch_count;
+  if (items.empty()) {
+    return false;
+  }
+  const VkDeviceSize items_size = sizeof(CullItem) * items.size();
+  bool reallocated = ReserveBuffer(*device_, cull_frame.items, &cull_frame.mapped_items,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                items_size);
+  if (reallocated || cull_frame.items_version != items_version) {
+    std::memcpy(cull_frame.mapped_items, items.data(), items_size);
+    cull_frame.items_version = items_version;
+  }
+
+  reallocated |= ReserveBuffer(*device_, cull_frame.commands, nullptr,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                sizeof(VkDrawIndexedIndirectCommand) * items.size());
+  reallocated |= ReserveBuffer(*device_, cull_frame.counts, &cull_frame.mapped_counts,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                sizeof(uint32_t) * batch_count);
+
+  // Rewriting the set invalidates the commands recorded with it, so only do
+  // so once one of the buffers or the pyramid has been replaced.
+  if (!reallocated && !cull_frame.descriptors_dirty && cull_frame.transforms == transforms.handle()) {
+    return false;
+  }
+  cull_frame.transforms = transforms.handle();
+  cull_frame.descriptors_dirty = false;
+
+  const std::array<VkBuffer, 4> buffers = {cull_frame.items.handle(), transforms.handle(), cull_frame.commands.handle(), cull_frame.counts.handle()};
+  std::array<VkDescriptorBufferInfo, 4> buffer_infos = {};
+  std::array<VkWriteDescriptorSet, 6> descriptor_writes = {};
+  for(uint32_t i = 0; i < buffers.size(); ++i) {
+    buffer_infos[i].buffer = buffers[i];
+    buffer_infos[i].offset = 0;
+    buffer_infos[i].range = VK_WHOLE_SIZE;
+
+    descriptor_writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_writes[i].dstSet = cull_frame.descriptor_set;
+    descriptor_writes[i].dstBinding = i;
+    descriptor_writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptor_writes[i].descriptorCount = 1;
+    descriptor_writes[i].pBufferInfo = &buffer_infos[i];
+  }
+  VkDescriptorImageInfo pyramid_info = {};
+  pyramid_info.imageView = pyramid_.view();
+  pyramid_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+  descriptor_writes[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptor_writes[4].dstSet = cull_frame.descriptor_set;
+  descriptor_writes[4].dstBinding = 4;
+  descriptor_writes[4].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  descriptor_writes[4].descriptorCount = 1;
+  descriptor_writes[4].pImageInfo = &pyramid_info;
+
+  VkDescriptorBufferInfo view_proj_info = {};
+  view_proj_info.buffer = cull_frame.pyramid_view_proj.handle();
+  view_proj_info.offset = 0;
+  view_proj_info.range = VK_WHOLE_SIZE;
+
+  descriptor_writes[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptor_writes[5].dstSet = cull_frame.descriptor_set;
+  descriptor_writes[5].dstBinding = 5;
+  descriptor_writes[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  descriptor_writes[5].descriptorCount = 1;
+  descriptor_writes[5].pBufferInfo = &view_proj_info;
+
+  vkUpdateDescriptorSets(device_->handle(), static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
+  return true;
+}
+
+void GpuCuller::RecordCull(VkCommandBuffer cmd_buffer, const size_t frame, const glm::mat4& view_proj) const {
+  const CullFrame& cull_frame = frames_[frame];
+  if (cull_frame.item_count == 0) {
+    return;
+  }
+  // Until the first pyramid is built its layout is still undefined.
+  if (!pyramid_ready_) {
+    const VkImageMemoryBarrier pyramid_barrier = CreateImageBarrier(pyramid_.handle(), VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &pyramid_barrier);
+  }
+  vkCmdFillBuffer(cmd_buffer, cull_frame.counts.handle(), 0, sizeof(uint32_t) * cull_frame.batch_count, 0);
+
+  // Waits for the cleared counts and for the pyramid built last frame.
+  RecordMemoryBarrier(cmd_buffer,
+                      VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                      VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+  CullConstants constants = {};
+  constants.view_proj = view_proj;
+  constants.pyramid_size = glm::ivec2(pyramid_.extent().width, pyramid_.extent().height);
+  constants.pyramid_levels = pyramid_ready_ ? static_cast<uint32_t>(pyramid_levels_.size()) : 0;
+  constants.item_count = cull_frame.item_count;
+
+  vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline_.handle());
+  vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline_layout_.handle(), 0, 1, &cull_frame.descriptor_set, 0, nullptr);
+  vkCmdPushConstants(cmd_buffer, cull_pipeline_layout_.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+  vkCmdDispatch(cmd_buffer, GroupCount(cull_frame.item_count, kCullGroupSize), 1, 1);
+
+  RecordMemoryBarrier(cmd_buffer,
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                      VK_ACCESS_SHADER_WRITE_BIT,
+                      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                      VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT);
+}
+
+void GpuCuller::RecordDraw(VkCommandBuffer cmd_buffer, const size_t frame, const uint32_t batch, const uint32_t first_command, const uint32_t command_count) const {
+  const CullFrame& cull_frame = frames_[frame];
+
+  draw_indexed_indirect_count_(
+    cmd_buffer,
+    cull_frame.commands.handle(),
+    first_command * kDrawCommandStride,
+    cull_frame.counts.handle(),
+    batch * sizeof(uint32_t),
+    command_count,
+    kDrawCommandStride
+  );
+}
+
+void GpuCuller::RecordDepthPyramid(VkCommandBuffer cmd_buffer, VkImage depth_image) {
+  // The whole pyramid is rewritten, so its previous contents are discarded.
+  std::array<VkImageMemoryBarrier, 2> barriers = {
+    CreateImageBarrier(depth_image, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL),
+    CreateImageBarrier(pyramid_.handle(), VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL)
+  };
+  barriers[0].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+  barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  barriers[1].srcAccessMask = 0;
+  barriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+  vkCmdPipelineBarrier(cmd_buffer,
+                       VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       0, 0, nullptr, 0, nullptr,
+                       static_cast<uint32_t>(barriers.size()), barriers.data());
+
+  vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pyramid_pipeline_.handle());
+  for(const DepthPyramidLevel& level : pyramid_levels_) {
+    PyramidConstants constants = {};
+    constants.input_size = glm::ivec2(level.input_extent.width, level.input_extent.height);
+    constants.output_size = glm::ivec2(level.extent.width, level.extent.height);
+
+    vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pyramid_pipeline_layout_.handle(), 0, 1, &level.descriptor_set, 0, nullptr);
+    vkCmdPushConstants(cmd_buffer, pyramid_pipeline_layout_.handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(cmd_buffer, GroupCount(level.extent.width, kPyramidGroupSize), GroupCount(level.extent.height, kPyramidGroupSize), 1);
+
+    RecordMemoryBarrier(cmd_buffer,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_SHADER_WRITE_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_ACCESS_SHADER_READ_BIT);
+  }
+  // Hand the depth image back to the next render pass once it has been read.
+  VkImageMemoryBarrier depth_barrier = CreateImageBarrier(depth_image, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+  depth_barrier.srcAccessMask = 0;
+  depth_barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+  vkCmdPipelineBarrier(cmd_buffer,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                       0, 0, nullptr, 0, nullptr, 1, &depth_barrier);
+
+  pyramid_ready_ = true;
+}
+
+} // namespace vk
@@ -0,0 +1,122 @@
+#ifndef BACKEND_VK_RENDERER_GPU_CULLER_H_
+#define BACKEND_VK_RENDERER_GPU_CULLER_H_
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "backend/vk/renderer/buffer.h"
+#include "backend/vk/renderer/deletion_queue.h"
+#include "backend/vk/renderer/device.h"
+#include "backend/vk/renderer/handle.h"
+#include "backend/vk/renderer/image.h"
+#include "engine/render/types.h"
+
+namespace vk {
+
+// One instance of one draw command, laid out as CullItem in shaders/cull.comp.
+struct CullItem {
+  glm::vec4 sphere;
+  uint32_t index_count;
+  uint32_t first_index;
+  int32_t vertex_offset;
+  uint32_t instance;
+  uint32_t batch;
+  uint32_t first_command;
+  uint32_t padding[2];
+};
+
+struct CullFrame {
+  Buffer items;
+  void* mapped_items;
+  Buffer commands;
+  Buffer counts;
+  void* mapped_counts;
+  VkDescriptorSet descriptor_set;
+  VkBuffer transforms;
+  bool descriptors_dirty;
+  uint64_t items_version;
+  // View projection the pyramid read by this frame's cull was built with.
+  Buffer pyramid_view_proj;
+  void* mapped_pyramid_view_proj;
+
+  uint32_t item_count;
+  uint32_t batch_count;
+};
+
+struct DepthPyramidLevel {
+  DeviceHandle<VkImageView> view;
+  VkDescriptorSet descriptor_set;
+  VkExtent2D input_extent;
+  VkExtent2D extent;
+};
+
+// Culls every instance of every draw command on the GPU against the frustum
+// and a max-depth pyramid reduced from the previous frame's depth image. The
+// survivors are compacted per draw batch into an indirect buffer drawn with
+// vkCmdDrawIndexedIndirectCountKHR, so the host never reads culling results
+// back within a frame.
+class GpuCuller {
+public:
+  [[nodiscard]] static bool IsSupported(const PhysicalDevice& physical_device);
+
+  GpuCuller() noexcept;
+  GpuCuller(const Device& device, VkPipelineCache pipeline_cache, size_t frame_count);
+  ~GpuCuller() = default;
+
+  GpuCuller(GpuCuller&& other) noexcept = default;
+  GpuCuller& operator=(GpuCuller&& other) noexcept = default;
+
+  // Rebuilds the pyramid for a new depth image. The previous one may still
+  // be in use by frames in flight, so it is handed to the deletion queue.
+  void SetDepthImage(const Image& depth_image, DeletionQueue& deletion_queue);
+  // Called every frame with the view projection it renders with. The items
+  // are only uploaded when items_version differs from the frame's last one.
+  // Returns true when the descriptor set of the frame had to be rewritten,
+  // which invalidates any command buffer recorded for it.
+  bool Prepare(size_t frame, const std::vector<CullItem>& items, uint64_t items_version, uint32_t batch_count,
+               const Buffer& transforms, const glm::mat4& view_proj);
+
+  void RecordCull(VkCommandBuffer cmd_buffer, size_t frame, const glm::mat4& view_proj) const;
+  void RecordDraw(VkCommandBuffer cmd_buffer, size_t frame, uint32_t batch, uint32_t first_command, uint32_t command_count) const;
+  void RecordDepthPyramid(VkCommandBuffer cmd_buffer, VkImage depth_image);
+
+  [[nodiscard]] bool pyramid_ready() const noexcept;
+  [[nodiscard]] engine::DrawStats stats() const noexcept;
+private:
+  const Device* device_;
+  PFN_vkCmdDrawIndexedIndirectCountKHR draw_indexed_indirect_count_;
+
+  DeviceHandle<VkDescriptorSetLayout> cull_layout_;
+  DeviceHandle<VkPipelineLayout> cull_pipeline_layout_;
+  DeviceHandle<VkPipeline> cull_pipeline_;
+  DeviceHandle<VkDescriptorPool> cull_descriptor_pool_;
+  std::vector<CullFrame> frames_;
+
+  DeviceHandle<VkDescriptorSetLayout> pyramid_layout_;
+  DeviceHandle<VkPipelineLayout> pyramid_pipeline_layout_;
+  DeviceHandle<VkPipeline> pyramid_pipeline_;
+  DeviceHandle<VkDescriptorPool> pyramid_descriptor_pool_;
+  Image pyramid_;
+  std::vector<DepthPyramidLevel> pyramid_levels_;
+  bool pyramid_ready_;
+  // Every frame builds the pyramid read by the next one.
+  glm::mat4 last_view_proj_;
+
+  engine::DrawStats stats_;
+};
+
+inline GpuCuller::GpuCuller() noexcept
+  : device_(nullptr), draw_indexed_indirect_count_(nullptr), pyramid_ready_(false), last_view_proj_(1.0f), stats_() {}
+
+inline bool GpuCuller::pyramid_ready() const noexcept {
+  return pyramid_ready_;
+}
+
+inline engine::DrawStats GpuCuller::stats() const noexcept {
+  return stats_;
+}
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_GPU_CULLER_H_
@@ -0,0 +1,110 @@
+#include "backend/vk/renderer/gpu_profiler.h"
+
+#include <algorithm>
+#include <array>
+
+#include "backend/vk/renderer/error.h"
+
+namespace vk {
+
+namespace {
+
+constexpr uint32_t kGroupBase = 1 + GpuProfiler::kMaxPassCount;
+// Room for this many draw groups is allocated up front.
+constexpr uint32_t kInitialGroupCount = 64;
+
+// Returns false when the results are not available yet.
+bool GetTimestamps(VkDevice device, VkQueryPool pool, const uint32_t first, const uint32_t count, uint64_t* timestamps) {
+  const VkResult result = vkGetQueryPoolResults(device, pool, first, count, sizeof(uint64_t) * count,
+                                                timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+  if (result == VK_NOT_READY) {
+    return false;
+  }
+  if (result != VK_SUCCESS) {
+    throw Error("failed to get timestamp query results").WithCode(result);
+  }
+  return true;
+}
+
+} // namespace
+
+bool GpuProfiler::IsSupported(const PhysicalDevice& physical_device) {
+  return physical_device.GetProperties().limits.timestampComputeAndGraphics == VK_TRUE;
+}
+
+GpuProfiler::GpuProfiler(const Device& device, const size_t frame_count)
+  : device_(&device),
+    timestamp_period_(device.physical_device().GetProperties().limits.timestampPeriod),
+    frames_(frame_count),
+    timings_() {
+  for(TimestampFrame& frame : frames_) {
+    frame.capacity = kGroupBase + kInitialGroupCount + 1;
+    frame.pool = device.CreateQueryPool(VK_QUERY_TYPE_TIMESTAMP, frame.capacity);
+    frame.submitted = false;
+  }
+}
+
+void GpuProfiler::Read(const size_t frame) {
+  TimestampFrame& timestamp_frame = frames_[frame];
+  if (!timestamp_frame.submitted) {
+    return;
+  }
+  timestamp_frame.submitted = false;
+
+  const auto pass_count = static_cast<uint32_t>(timestamp_frame.passes.size());
+  const auto group_count = static_cast<uint32_t>(timestamp_frame.groups.size());
+  std::array<uint64_t, kMaxPassCount + 1> pass_timestamps = {};
+  group_timestamps_.resize(group_count + 1);
+  if (pass_count == 0 ||
+      !GetTimestamps(device_->handle(), timestamp_frame.pool.handle(), 0, pass_count + 1, pass_timestamps.data()) ||
+      (group_count != 0 && !GetTimestamps(device_->handle(), timestamp_frame.pool.handle(), kGroupBase, group_count + 1, group_timestamps_.data()))) {
+    return;
+  }
+  timings_.frame = ToMilliseconds(pass_timestamps[0], pass_timestamps[pass_count]);
+  timings_.passes.resize(pass_count);
+  for(uint32_t i = 0; i < pass_count; ++i) {
+    timings_.passes[i] = {timestamp_frame.passes[i], ToMilliseconds(pass_timestamps[i], pass_timestamps[i + 1])};
+  }
+  timings_.groups = timestamp_frame.groups;
+  for(uint32_t i = 0; i < group_count; ++i) {
+    timings_.groups[i].time = ToMilliseconds(group_timestamps_[i], group_timestamps_[i + 1]);
+  }
+}
+
+bool GpuProfiler::Prepare(const size_t frame, const std::vector<engine::GpuGroupTime>& groups) {
+  TimestampFrame& timestamp_frame = frames_[frame];
+  timestamp_frame.groups = groups;
+
+  const auto capacity = static_cast<uint32_t>(kGroupBase + groups.size() + 1);
+  if (capacity <= timestamp_frame.capacity) {
+    return false;
+  }
+  timestamp_frame.capacity = std::max(capacity, 2 * timestamp_frame.capacity);
+  timestamp_frame.pool = device_->CreateQueryPool(VK_QUERY_TYPE_TIMESTAMP, timestamp_frame.capacity);
+  return true;
+}
+
+void GpuProfiler::RecordBegin(VkCommandBuffer cmd_buffer, const size_t frame) {
+  TimestampFrame& timestamp_frame = frames_[frame];
+  timestamp_frame.passes.clear();
+
+  vkCmdResetQueryPool(cmd_buffer, timestamp_frame.pool.handle(), 0, timestamp_frame.capacity);
+  vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_frame.pool.handle(), 0);
+}
+
+void GpuProfiler::RecordPassEnd(VkCommandBuffer cmd_buffer, const size_t frame, const char* name) {
+  TimestampFrame& timestamp_frame = frames_[frame];
+  if (timestamp_frame.passes.size() == kMaxPassCount) {
+    throw Error("too many profiled passes");
+  }
+  timestamp_frame.passes.push_back(name);
+  vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_frame.pool.handle(), static_cast<uint32_t>(timestamp_frame.passes.size()));
+}
+
+// Every draw of the previous groups has completed by the timestamp, so the
+// difference between boundaries approximates each group's own GPU time.
+void GpuProfiler::RecordGroupBoundary(VkCommandBuffer cmd_buffer, const size_t frame, const uint32_t boundary) const {
+  vkCmdWriteTimestamp(cmd_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames_[frame].pool.handle(), kGroupBase + boundary);
+}
+
+} // namespace vk
@@ -0,0 +1,86 @@
+#ifndef BACKEND_VK_RENDERER_GPU_PROFILER_H_
+#define BACKEND_VK_RENDERER_GPU_PROFILER_H_
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "backend/vk/renderer/device.h"
+#include "backend/vk/renderer/handle.h"
+#include "engine/render/types.h"
+
+namespace vk {
+
+// Timestamp queries of one frame slot: the frame begin, the end of each
+// pass, then the boundaries between draw groups.
+struct TimestampFrame {
+  DeviceHandle<VkQueryPool> pool;
+  uint32_t capacity;
+  std::vector<const char*> passes;
+  std::vector<engine::GpuGroupTime> groups;
+  bool submitted;
+};
+
+// Times the passes and usemtl draw groups of every frame with a timestamp
+// query pool per frame slot. A slot's results are read once its fence has
+// signaled, one or more frames later, so reading never stalls the GPU.
+class GpuProfiler {
+public:
+  static constexpr uint32_t kMaxPassCount = 8;
+
+  [[nodiscard]] static bool IsSupported(const PhysicalDevice& physical_device);
+
+  GpuProfiler() noexcept;
+  GpuProfiler(const Device& device, size_t frame_count);
+  ~GpuProfiler() = default;
+
+  GpuProfiler(GpuProfiler&& other) noexcept = default;
+  GpuProfiler& operator=(GpuProfiler&& other) noexcept = default;
+
+  // Reads the previous submission of the slot, whose fence has signaled.
+  void Read(size_t frame);
+  // Sets the draw groups of the slot's next submission. Returns true when
+  // its pool had to grow, which invalidates command buffers recorded for it.
+  bool Prepare(size_t frame, const std::vector<engine::GpuGroupTime>& groups);
+  void Submit(size_t frame) noexcept;
+
+  void RecordBegin(VkCommandBuffer cmd_buffer, size_t frame);
+  // Ends the pass started by the previous pass end, or by the frame begin.
+  void RecordPassEnd(VkCommandBuffer cmd_buffer, size_t frame, const char* name);
+  // Boundary i starts draw group i, the last one ends the last group. Safe
+  // to record from several threads into different command buffers.
+  void RecordGroupBoundary(VkCommandBuffer cmd_buffer, size_t frame, uint32_t boundary) const;
+
+  [[nodiscard]] bool enabled() const noexcept;
+  [[nodiscard]] const engine::GpuTimings& timings() const noexcept;
+private:
+  [[nodiscard]] double ToMilliseconds(uint64_t begin, uint64_t end) const noexcept;
+
+  const Device* device_;
+  float timestamp_period_;
+  std::vector<TimestampFrame> frames_;
+  std::vector<uint64_t> group_timestamps_;
+  engine::GpuTimings timings_;
+};
+
+inline GpuProfiler::GpuProfiler() noexcept : device_(nullptr), timestamp_period_(0.0f), timings_() {}
+
+inline void GpuProfiler::Submit(const size_t frame) noexcept {
+  frames_[frame].submitted = true;
+}
+
+inline bool GpuProfiler::enabled() const noexcept {
+  return !frames_.empty();
+}
+
+inline const engine::GpuTimings& GpuProfiler::timings() const noexcept {
+  return timings_;
+}
+
+inline double GpuProfiler::ToMilliseconds(const uint64_t begin, const uint64_t end) const noexcept {
+  return static_cast<double>(end - begin) * timestamp_period_ / 1e6;
+}
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_GPU_PROFILER_H_
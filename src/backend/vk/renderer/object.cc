@@ -31,6 +31,45 @@ std::vector<VkVertexInputAttributeDescription> Vertex::GetAttributeDescriptions(
   return attribute_descriptions;
 }
 
+std::vector<VkVertexInputBindingDescription> VertexMaterial::GetBindingDescriptions() {
+  std::vector<VkVertexInputBindingDescription> binding_descriptions(1);
+  binding_descriptions[0].binding = 1;
+  binding_descriptions[0].stride = sizeof(VertexMaterial);
+  binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  return binding_descriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> VertexMaterial::GetAttributeDescriptions() {
+  std::vector<VkVertexInputAttributeDescription> attribute_descriptions(1);
+  attribute_descriptions[0].binding = 1;
+  attribute_descriptions[0].location = 3;
+  attribute_descriptions[0].format = VK_FORMAT_R32_UINT;
+  attribute_descriptions[0].offset = offsetof(VertexMaterial, material);
+
+  return attribute_descriptions;
+}
+
+std::vector<VkVertexInputBindingDescription> InstanceTransform::GetBindingDescriptions() {
+  std::vector<VkVertexInputBindingDescription> binding_descriptions(1);
+  binding_descriptions[0].binding = 2;
+  binding_descriptions[0].stride = sizeof(InstanceTransform);
+  binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+  return binding_descriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> InstanceTransform::GetAttributeDescriptions() {
+  std::vector<VkVertexInputAttributeDescription> attribute_descriptions(4);
+  for(uint32_t i = 0; i < 4; ++i) {
+    attribute_descriptions[i].binding = 2;
+    attribute_descriptions[i].location = 4 + i;
+    attribute_descriptions[i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attribute_descriptions[i].offset = offsetof(InstanceTransform, model) + i * sizeof(glm::vec4);
+  }
+  return attribute_descriptions;
+}
+
 void UniformDescriptorSet::Update() const noexcept {
   VkDescriptorBufferInfo buffer_info = {};
   buffer_info.buffer = buffer.handle();
@@ -52,19 +91,19 @@ void UniformDescriptorSet::Update() const noexcept {
 void SamplerDescriptorSet::Update() const noexcept {
   VkDescriptorImageInfo image_info = {};
   image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-  image_info.imageView = image.view();
-  image_info.sampler = sampler.handle();
+  image_info.imageView = image->view();
+  image_info.sampler = sampler->handle();
 
   VkWriteDescriptorSet descriptor_write = {};
   descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
   descriptor_write.dstSet = handle;
   descriptor_write.dstBinding = 0;
-  descriptor_write.dstArrayElement = 0;
+  descriptor_write.dstArrayElement = array_element;
   descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
   descriptor_write.descriptorCount = 1;
   descriptor_write.pImageInfo = &image_info;
 
-  vkUpdateDescriptorSets(image.creator(), 1, &descriptor_write, 0, nullptr);
+  vkUpdateDescriptorSets(image->creator(), 1, &descriptor_write, 0, nullptr);
 }
 
 } // namespace vk
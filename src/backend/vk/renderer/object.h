@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include <memory>
 #include <vector>
 
 #include "backend/vk/renderer/buffer.h"
@@ -33,6 +34,22 @@ struct IndexType<uint32_t> {
   static constexpr VkIndexType value = VK_INDEX_TYPE_UINT32;
 };
 
+// Per-vertex material index, only bound in bindless mode.
+struct VertexMaterial {
+  uint32_t material;
+
+  static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+  static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+};
+
+// Per-instance model matrix, selected by the firstInstance of each draw.
+struct InstanceTransform {
+  glm::mat4 model;
+
+  static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+  static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+};
+
 struct Uniforms : engine::Uniforms {};
 
 struct UniformDescriptorSet {
@@ -42,31 +59,60 @@ struct UniformDescriptorSet {
   void Update() const noexcept;
 };
 
+// The camera uniforms, one set per frame in flight. Model matrices are
+// per-instance vertex data, so nothing else is a uniform.
+struct UniformDescriptor {
+  std::vector<UniformDescriptorSet> sets;
+  DeviceHandle<VkDescriptorSetLayout> layout;
+  DeviceHandle<VkDescriptorPool> descriptor_pool;
+};
+
 struct SamplerDescriptorSet {
-  DeviceHandle<VkSampler> sampler;
-  Image image;
+  std::shared_ptr<const DeviceHandle<VkSampler>> sampler;
+  std::shared_ptr<const Image> image;
   VkDescriptorSet handle;
+  uint32_t array_element;
 
   void Update() const noexcept;
 };
 
-struct UniformDescriptor {
-  std::vector<UniformDescriptorSet> sets;
-  DeviceHandle<VkDescriptorSetLayout> layout;
-};
-
 struct SamplerDescriptor {
   std::vector<SamplerDescriptorSet> sets;
+};
+
+// Material descriptor set layout shared by every object so that a single
+// pipeline can draw all of them. In bindless mode the renderer owns the one
+// set, an array of up to descriptor_count textures bound once per command
+// buffer, and each mesh's materials take the next elements of it.
+struct MaterialLayout {
   DeviceHandle<VkDescriptorSetLayout> layout;
+  uint32_t descriptor_count;
+  bool bindless;
+
+  DeviceHandle<VkDescriptorPool> descriptor_pool;
+  VkDescriptorSet descriptor_set;
+  uint32_t next_element;
+};
+
+// Consecutive VkDrawIndexedIndirectCommand entries sharing one material.
+struct DrawGroup {
+  uint32_t material;
+  uint32_t first_command;
+  uint32_t command_count;
 };
 
 struct Object {
   Buffer indices;
   Buffer vertices;
 
-  std::vector<obj::UseMtl> usemtl;
+  Buffer materials;
+
+  std::vector<VkDrawIndexedIndirectCommand> draw_commands;
+  std::vector<DrawGroup> draw_groups;
+  // Object space bounding sphere of each draw command, center in xyz and
+  // radius in w.
+  std::vector<glm::vec4> draw_bounds;
 
-  UniformDescriptor uniform_descriptor;
   SamplerDescriptor sampler_descriptor;
 
   DeviceHandle<VkDescriptorPool> descriptor_pool;
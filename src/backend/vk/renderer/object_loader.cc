@@ -1,7 +1,11 @@
 #include "backend/vk/renderer/object_loader.h"
 
+#include <algorithm>
 #include <cstring>
+#include <filesystem>
+#include <limits>
 #include <memory>
+#include <tuple>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -10,6 +14,7 @@
 #include "backend/vk/renderer/commander.h"
 #include "backend/vk/renderer/error.h"
 #include "obj/parser.h"
+#include "trace/trace.h"
 
 namespace vk {
 
@@ -23,36 +28,76 @@ inline uint32_t CalculateMipMaps(const VkExtent2D extent) {
     return static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
 }
 
+std::string GetTextureKey(const std::string& path) {
+  if (path.empty()) {
+    return path;
+  }
+  std::error_code error;
+  const std::filesystem::path canonical_path = std::filesystem::weakly_canonical(path, error);
+
+  return error ? path : canonical_path.string();
+}
+
+std::vector<glm::vec4> CreateDrawBounds(const obj::Data& data, const std::vector<VkDrawIndexedIndirectCommand>& draw_commands) {
+  std::vector<glm::vec4> draw_bounds;
+  draw_bounds.reserve(draw_commands.size());
+
+  for(const VkDrawIndexedIndirectCommand& command : draw_commands) {
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    for(uint32_t i = command.firstIndex; i < command.firstIndex + command.indexCount; ++i) {
+      const unsigned int i_v = data.indices[i].fv * 3;
+      const glm::vec3 pos(data.v[i_v], data.v[i_v + 1], data.v[i_v + 2]);
+      min = glm::min(min, pos);
+      max = glm::max(max, pos);
+    }
+    draw_bounds.emplace_back((min + max) * 0.5f, glm::length(max - min) * 0.5f);
+  }
+  return draw_bounds;
+}
+
 } // namespace
 
 void ObjectLoader::Init() noexcept {
   stbi_set_flip_vertically_on_load(true);
 }
 
-ObjectLoader::ObjectLoader(const Device& device, VkCommandPool cmd_pool) noexcept
+ObjectLoader::ObjectLoader(const Device& device, VkCommandPool cmd_pool, TextureCache& texture_cache, SamplerCache& sampler_cache, const MaterialLayout& material_layout) noexcept
   : device_(device),
-    cmd_pool_(cmd_pool) {}
+    cmd_pool_(cmd_pool),
+    texture_cache_(texture_cache),
+    sampler_cache_(sampler_cache),
+    material_layout_(material_layout) {}
 
-Object ObjectLoader::Load(const std::string& path, const size_t frame_count) const {
+Object ObjectLoader::Load(const std::string& path, const uint32_t material_base) const {
+  TRACE_ZONE("ObjectLoader::Load");
   obj::Data data = obj::ParseFromFile(path);
 
-  auto[transfer_vertices, transfer_indices] = CreateTransferBuffers(data);
+  auto[transfer_vertices, transfer_indices, transfer_materials] = CreateTransferBuffers(data, material_base);
 
   Object object = {};
   object.vertices = CreateStagingBuffer(transfer_vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
   object.indices = CreateStagingBuffer(transfer_indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
-  object.usemtl = std::move(data.usemtl);
-
-  std::vector<Image> images = CreateStagingImages(data);
-
-  object.descriptor_pool = device_.CreateDescriptorPool(frame_count, images.size());
-  object.uniform_descriptor = CreateUniformDescriptor(object.descriptor_pool.handle(), frame_count);
-  object.sampler_descriptor = CreateSamplerDescriptor(object.descriptor_pool.handle(), std::move(images));
+  if (material_layout_.bindless) {
+    object.materials = CreateStagingBuffer(transfer_materials, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+  }
+  std::tie(object.draw_commands, object.draw_groups) = CreateDrawCommands(data.usemtl);
+  object.draw_bounds = CreateDrawBounds(data, object.draw_commands);
+
+  std::vector<std::shared_ptr<const Image>> images = CreateStagingImages(data);
+  if (material_layout_.bindless) {
+    if (material_base + images.size() > material_layout_.descriptor_count) {
+      throw Error("too many materials for the bindless texture array");
+    }
+  } else {
+    object.descriptor_pool = device_.CreateDescriptorPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, images.size());
+  }
+  object.sampler_descriptor = CreateSamplerDescriptor(object.descriptor_pool.handle(), std::move(images), material_base);
 
   return object;
 }
 
-std::pair<Buffer, Buffer> ObjectLoader::CreateTransferBuffers(const obj::Data& data) const {
+std::tuple<Buffer, Buffer, Buffer> ObjectLoader::CreateTransferBuffers(const obj::Data& data, const uint32_t material_base) const {
   Buffer transfer_vertices = device_.CreateBuffer(
     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
@@ -66,12 +111,28 @@ std::pair<Buffer, Buffer> ObjectLoader::CreateTransferBuffers(const obj::Data& d
   const auto mapped_vertices = static_cast<Vertex*>(transfer_vertices.memory().Map());
   const auto mapped_indices = static_cast<Index*>(transfer_indices.memory().Map());
 
-  engine::data_util::RemoveDuplicates(data, mapped_vertices, mapped_indices);
+  if (!material_layout_.bindless) {
+    engine::data_util::RemoveDuplicates(data, mapped_vertices, mapped_indices);
+
+    transfer_vertices.memory().Unmap();
+    transfer_indices.memory().Unmap();
+
+    return {std::move(transfer_vertices), std::move(transfer_indices), Buffer()};
+  }
+  Buffer transfer_materials = device_.CreateBuffer(
+    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+    sizeof(VertexMaterial) * data.indices.size()
+  );
+  const auto mapped_materials = static_cast<uint32_t*>(transfer_materials.memory().Map());
+
+  engine::data_util::RemoveDuplicates(data, mapped_vertices, mapped_indices, mapped_materials, material_base);
 
   transfer_vertices.memory().Unmap();
   transfer_indices.memory().Unmap();
+  transfer_materials.memory().Unmap();
 
-  return {std::move(transfer_vertices), std::move(transfer_indices)};
+  return {std::move(transfer_vertices), std::move(transfer_indices), std::move(transfer_materials)};
 }
 
 inline Buffer ObjectLoader::CreateStagingBuffer(const Buffer& transfer_buffer, const VkBufferUsageFlags usage) const {
@@ -89,6 +150,48 @@ inline Buffer ObjectLoader::CreateStagingBuffer(const Buffer& transfer_buffer, c
   return buffer;
 }
 
+std::pair<std::vector<VkDrawIndexedIndirectCommand>, std::vector<DrawGroup>> ObjectLoader::CreateDrawCommands(const std::vector<obj::UseMtl>& usemtl) const {
+  std::vector<std::pair<uint32_t, VkDrawIndexedIndirectCommand>> commands;
+  commands.reserve(usemtl.size());
+
+  uint32_t prev_offset = 0;
+  for(const auto[index, offset] : usemtl) {
+    if (offset == prev_offset) {
+      continue;
+    }
+    VkDrawIndexedIndirectCommand command = {};
+    command.indexCount = offset - prev_offset;
+    command.instanceCount = 1;
+    command.firstIndex = prev_offset;
+    command.vertexOffset = 0;
+    command.firstInstance = 0;
+    commands.emplace_back(index, command);
+
+    prev_offset = offset;
+  }
+  if (commands.empty()) {
+    return {};
+  }
+  std::stable_sort(commands.begin(), commands.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+  std::vector<VkDrawIndexedIndirectCommand> draw_commands;
+  draw_commands.reserve(commands.size());
+  std::vector<DrawGroup> draw_groups;
+
+  for(const auto& [material, command] : commands) {
+    // Bindless draws read the material from the vertex stream, so the whole
+    // object is a single group drawn from the shared descriptor array.
+    const uint32_t group_material = material_layout_.bindless ? 0 : material;
+    if (draw_groups.empty() || draw_groups.back().material != group_material) {
+      draw_groups.push_back({group_material, static_cast<uint32_t>(draw_commands.size()), 0});
+    }
+    ++draw_groups.back().command_count;
+    draw_commands.push_back(command);
+  }
+  return {std::move(draw_commands), std::move(draw_groups)};
+}
+
 Image ObjectLoader::CreateStagingImageFromPixels(const unsigned char* pixels, const VkExtent2D extent, const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties) const {
   const VkDeviceSize image_size = extent.width * extent.height * kStbiFormat;
 
@@ -124,7 +227,11 @@ Image ObjectLoader::CreateStagingImage(const std::string& path,
                                        const VkBufferUsageFlags usage,
                                        const VkMemoryPropertyFlags properties) const {
   int image_width, image_height, image_channels;
-  const std::unique_ptr<stbi_uc, void(*)(void*)> pixels(stbi_load(path.c_str(), &image_width, &image_height, &image_channels, kStbiFormat), stbi_image_free);
+  std::unique_ptr<stbi_uc, void(*)(void*)> pixels(nullptr, stbi_image_free);
+  {
+    TRACE_ZONE("decode texture");
+    pixels.reset(stbi_load(path.c_str(), &image_width, &image_height, &image_channels, kStbiFormat));
+  }
   if (pixels == nullptr) {
     constexpr size_t dummy_size = kDummyImageExtent.width * kDummyImageExtent.height;
     const std::vector<unsigned char> dummy_colors(dummy_size, 0xff);
@@ -135,7 +242,7 @@ Image ObjectLoader::CreateStagingImage(const std::string& path,
   return CreateStagingImageFromPixels(pixels.get(), image_extent, usage, properties);
 }
 
-std::vector<Image> ObjectLoader::CreateStagingImages(const obj::Data& data) const {
+std::vector<std::shared_ptr<const Image>> ObjectLoader::CreateStagingImages(const obj::Data& data) const {
   if (!device_.physical_device().CheckFormatFeatureSupported(kVkFormat, VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
     throw Error("image format does not support linear blitting");
   }
@@ -144,63 +251,48 @@ std::vector<Image> ObjectLoader::CreateStagingImages(const obj::Data& data) cons
                                       VK_IMAGE_USAGE_SAMPLED_BIT;
   constexpr VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-  std::vector<Image> images;
-  images.reserve(data.mtl.size());
+  std::vector<std::shared_ptr<const Image>> images;
+  images.reserve(std::max<size_t>(data.mtl.size(), 1));
+  if (data.mtl.empty()) {
+    // Without materials every vertex uses material 0, drawn with the dummy
+    // texture a material without a map gets.
+    images.emplace_back(texture_cache_.Get(std::string(), [&] {
+      return CreateStagingImage(std::string(), usage, properties);
+    }));
+  }
 
   for(const obj::NewMtl& mtl : data.mtl) {
     const std::string& path = mtl.map_kd;
-    Image image = CreateStagingImage(path, usage, properties);
-    images.emplace_back(std::move(image));
+    images.emplace_back(texture_cache_.Get(GetTextureKey(path), [&] {
+      return CreateStagingImage(path, usage, properties);
+    }));
   }
   return images;
 }
 
-UniformDescriptor ObjectLoader::CreateUniformDescriptor(VkDescriptorPool descriptor_pool, const size_t frame_count) const {
-  DeviceHandle<VkDescriptorSetLayout> descriptor_set_layout = device_.CreateUniformDescriptorSetLayout();
-  const std::vector<VkDescriptorSet> descriptor_sets = device_.CreateDescriptorSets(descriptor_set_layout.handle(), descriptor_pool, frame_count);
-
-  std::vector<UniformDescriptorSet> uniform_descriptor_sets;
-  uniform_descriptor_sets.reserve(frame_count);
-
-  for(VkDescriptorSet descriptor_set : descriptor_sets) {
-    Buffer buffer = device_.CreateBuffer(
-      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-      sizeof(Uniforms)
-    );
-    UniformDescriptorSet uniform_descriptor_set = {};
-    uniform_descriptor_set.buffer = std::move(buffer);
-    uniform_descriptor_set.handle = descriptor_set;
-    uniform_descriptor_set.Update();
-
-    uniform_descriptor_sets.emplace_back(std::move(uniform_descriptor_set));
-  }
-  return {
-    std::move(uniform_descriptor_sets),
-    std::move(descriptor_set_layout),
-  };
-}
-
-SamplerDescriptor ObjectLoader::CreateSamplerDescriptor(VkDescriptorPool descriptor_pool, std::vector<Image>&& images) const {
-  DeviceHandle<VkDescriptorSetLayout> descriptor_set_layout =  device_.CreateSamplerDescriptorSetLayout();
-  const std::vector<VkDescriptorSet> descriptor_sets = device_.CreateDescriptorSets(descriptor_set_layout.handle(), descriptor_pool, images.size());
+SamplerDescriptor ObjectLoader::CreateSamplerDescriptor(VkDescriptorPool descriptor_pool, std::vector<std::shared_ptr<const Image>>&& images, const uint32_t material_base) const {
+  // In bindless mode every material is an element of the renderer's array.
+  const bool bindless = material_layout_.bindless;
+  const std::vector<VkDescriptorSet> descriptor_sets = bindless ? std::vector<VkDescriptorSet>() :
+      device_.CreateDescriptorSets(material_layout_.layout.handle(), descriptor_pool, images.size());
   std::vector<SamplerDescriptorSet> sampler_descriptor_sets;
   sampler_descriptor_sets.reserve(images.size());
 
   for(size_t i = 0; i < images.size(); ++i) {
     SamplerDescriptorSet sampler_descriptor_set = {};
 
-    sampler_descriptor_set.sampler = device_.CreateSampler(VK_SAMPLER_MIPMAP_MODE_LINEAR, images[i].mip_levels());
+    const SamplerKey sampler_key = {VK_SAMPLER_MIPMAP_MODE_LINEAR, images[i]->mip_levels()};
+    sampler_descriptor_set.sampler = sampler_cache_.Get(sampler_key, [&] {
+      return device_.CreateSampler(sampler_key.mipmap_mode, sampler_key.mip_levels);
+    });
     sampler_descriptor_set.image = std::move(images[i]);
-    sampler_descriptor_set.handle = descriptor_sets[i];
+    sampler_descriptor_set.handle = bindless ? material_layout_.descriptor_set : descriptor_sets[i];
+    sampler_descriptor_set.array_element = bindless ? material_base + static_cast<uint32_t>(i) : 0;
     sampler_descriptor_set.Update();
 
     sampler_descriptor_sets.emplace_back(std::move(sampler_descriptor_set));
   }
-  return {
-    std::move(sampler_descriptor_sets),
-    std::move(descriptor_set_layout),
-  };
+  return {std::move(sampler_descriptor_sets)};
 }
 
 } // namespace vk
\ No newline at end of file
@@ -1,11 +1,14 @@
 #ifndef BACKEND_VK_RENDERER_OBJECT_LOADER_H_
 #define BACKEND_VK_RENDERER_OBJECT_LOADER_H_
 
+#include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "backend/vk/renderer/device.h"
 #include "backend/vk/renderer/object.h"
+#include "backend/vk/renderer/resource_cache.h"
 
 namespace vk {
 
@@ -13,21 +16,26 @@ class ObjectLoader {
 public:
   static void Init() noexcept;
 
-  ObjectLoader(const Device& device, VkCommandPool cmd_pool) noexcept;
+  ObjectLoader(const Device& device, VkCommandPool cmd_pool, TextureCache& texture_cache, SamplerCache& sampler_cache, const MaterialLayout& material_layout) noexcept;
   ~ObjectLoader() = default;
 
-  [[nodiscard]] Object Load(const std::string& path, size_t frame_count) const;
+  // In bindless mode the materials take the elements of the shared set from
+  // material_base on.
+  [[nodiscard]] Object Load(const std::string& path, uint32_t material_base) const;
 private:
-  [[nodiscard]] std::pair<Buffer, Buffer> CreateTransferBuffers(const obj::Data& data) const;
+  [[nodiscard]] std::tuple<Buffer, Buffer, Buffer> CreateTransferBuffers(const obj::Data& data, uint32_t material_base) const;
   [[nodiscard]] Buffer CreateStagingBuffer(const Buffer& transfer_buffer, VkBufferUsageFlags usage) const;
+  [[nodiscard]] std::pair<std::vector<VkDrawIndexedIndirectCommand>, std::vector<DrawGroup>> CreateDrawCommands(const std::vector<obj::UseMtl>& usemtl) const;
   [[nodiscard]] Image CreateStagingImageFromPixels(const unsigned char* pixels, VkExtent2D extent, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const;
   [[nodiscard]] Image CreateStagingImage(const std::string& path, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const;
-  [[nodiscard]] std::vector<Image> CreateStagingImages(const obj::Data& data) const;
-  [[nodiscard]] UniformDescriptor CreateUniformDescriptor(VkDescriptorPool descriptor_pool, size_t frame_count) const;
-  [[nodiscard]] SamplerDescriptor CreateSamplerDescriptor(VkDescriptorPool descriptor_pool, std::vector<Image>&& images) const;
+  [[nodiscard]] std::vector<std::shared_ptr<const Image>> CreateStagingImages(const obj::Data& data) const;
+  [[nodiscard]] SamplerDescriptor CreateSamplerDescriptor(VkDescriptorPool descriptor_pool, std::vector<std::shared_ptr<const Image>>&& images, uint32_t material_base) const;
 
   const Device& device_;
   VkCommandPool cmd_pool_;
+  TextureCache& texture_cache_;
+  SamplerCache& sampler_cache_;
+  const MaterialLayout& material_layout_;
 };
 
 } // namespace vk
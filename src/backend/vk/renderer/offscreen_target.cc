@@ -0,0 +1,99 @@
+#include "backend/vk/renderer/offscreen_target.h"
+
+#include <fstream>
+
+#include "backend/vk/renderer/error.h"
+
+namespace vk {
+
+namespace {
+
+constexpr uint32_t kPixelSize = 4;
+
+} // namespace
+
+OffscreenTarget::OffscreenTarget(const Device& device, const VkExtent2D extent, const size_t image_count, const bool readback)
+  : extent_(extent) {
+  VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  if (readback) {
+    usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+  }
+  images_.reserve(image_count);
+  for(size_t i = 0; i < image_count; ++i) {
+    images_.push_back(device.CreateImage(
+      usage,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      VK_IMAGE_ASPECT_COLOR_BIT, extent,
+      kFormat,
+      VK_IMAGE_TILING_OPTIMAL
+    ));
+    if (readback) {
+      readback_buffers_.push_back(device.CreateBuffer(
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        kPixelSize * extent.width * extent.height
+      ));
+      mapped_readbacks_.push_back(readback_buffers_.back().memory().Map());
+    }
+  }
+}
+
+void OffscreenTarget::RecordReadback(VkCommandBuffer cmd_buffer, const size_t image_idx) const {
+  VkImageMemoryBarrier image_barrier = {};
+  image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  image_barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  image_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  image_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  image_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  image_barrier.image = images_[image_idx].handle();
+  image_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  image_barrier.subresourceRange.levelCount = 1;
+  image_barrier.subresourceRange.layerCount = 1;
+
+  vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &image_barrier);
+
+  VkBufferImageCopy region = {};
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.layerCount = 1;
+  region.imageExtent = {extent_.width, extent_.height, 1};
+
+  vkCmdCopyImageToBuffer(cmd_buffer, images_[image_idx].handle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback_buffers_[image_idx].handle(), 1, &region);
+
+  VkBufferMemoryBarrier buffer_barrier = {};
+  buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  buffer_barrier.buffer = readback_buffers_[image_idx].handle();
+  buffer_barrier.size = VK_WHOLE_SIZE;
+
+  vkCmdPipelineBarrier(cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &buffer_barrier, 0, nullptr);
+}
+
+void OffscreenTarget::WriteReadback(const size_t image_idx, const std::filesystem::path& path) const {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    throw Error("failed to open readback file " + path.string());
+  }
+  file << "P6\n" << extent_.width << ' ' << extent_.height << "\n255\n";
+
+  const auto* pixels = static_cast<const unsigned char*>(mapped_readbacks_[image_idx]);
+  std::vector<char> row(3 * extent_.width);
+  for(uint32_t y = 0; y < extent_.height; ++y) {
+    for(uint32_t x = 0; x < extent_.width; ++x) {
+      const unsigned char* pixel = pixels + kPixelSize * (y * extent_.width + x);
+      row[3 * x] = static_cast<char>(pixel[0]);
+      row[3 * x + 1] = static_cast<char>(pixel[1]);
+      row[3 * x + 2] = static_cast<char>(pixel[2]);
+    }
+    file.write(row.data(), static_cast<std::streamsize>(row.size()));
+  }
+  if (!file) {
+    throw Error("failed to write readback file " + path.string());
+  }
+}
+
+} // namespace vk
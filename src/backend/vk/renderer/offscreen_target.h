@@ -0,0 +1,62 @@
+#ifndef BACKEND_VK_RENDERER_OFFSCREEN_TARGET_H_
+#define BACKEND_VK_RENDERER_OFFSCREEN_TARGET_H_
+
+#include <vulkan/vulkan.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "backend/vk/renderer/buffer.h"
+#include "backend/vk/renderer/device.h"
+#include "backend/vk/renderer/image.h"
+
+namespace vk {
+
+// Color images rendered to in place of a swapchain when the window is
+// headless, one per frame slot. With readback enabled each frame is also
+// copied into a host visible buffer of its slot, readable once the slot's
+// fence has signaled.
+class OffscreenTarget {
+public:
+  static constexpr VkFormat kFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+  OffscreenTarget() noexcept;
+  OffscreenTarget(const Device& device, VkExtent2D extent, size_t image_count, bool readback);
+  ~OffscreenTarget() = default;
+
+  OffscreenTarget(OffscreenTarget&& other) noexcept = default;
+  OffscreenTarget& operator=(OffscreenTarget&& other) noexcept = default;
+
+  // Expects the image in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, as left by
+  // the render pass.
+  void RecordReadback(VkCommandBuffer cmd_buffer, size_t image_idx) const;
+  // Writes the last frame read back from the image as a binary PPM.
+  void WriteReadback(size_t image_idx, const std::filesystem::path& path) const;
+
+  [[nodiscard]] const std::vector<Image>& images() const noexcept;
+  [[nodiscard]] VkExtent2D extent() const noexcept;
+  [[nodiscard]] bool readback() const noexcept;
+private:
+  VkExtent2D extent_;
+  std::vector<Image> images_;
+  std::vector<Buffer> readback_buffers_;
+  std::vector<void*> mapped_readbacks_;
+};
+
+inline OffscreenTarget::OffscreenTarget() noexcept : extent_() {}
+
+inline const std::vector<Image>& OffscreenTarget::images() const noexcept {
+  return images_;
+}
+
+inline VkExtent2D OffscreenTarget::extent() const noexcept {
+  return extent_;
+}
+
+inline bool OffscreenTarget::readback() const noexcept {
+  return !readback_buffers_.empty();
+}
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_OFFSCREEN_TARGET_H_
@@ -111,4 +111,38 @@ VkPhysicalDeviceFeatures PhysicalDevice::GetFeatures() const {
   return device_features;
 }
 
+bool PhysicalDevice::CheckDescriptorIndexingSupported() const {
+  if (GetProperties().apiVersion < VK_API_VERSION_1_1 ||
+      !CheckExtensionsSupport({VK_KHR_MAINTENANCE3_EXTENSION_NAME, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME})) {
+    return false;
+  }
+  VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features = {};
+  indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+  VkPhysicalDeviceFeatures2 device_features = {};
+  device_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  device_features.pNext = &indexing_features;
+  vkGetPhysicalDeviceFeatures2(physical_device_, &device_features);
+
+  return indexing_features.runtimeDescriptorArray &&
+         indexing_features.shaderSampledImageArrayNonUniformIndexing &&
+         indexing_features.descriptorBindingPartiallyBound &&
+         indexing_features.descriptorBindingUpdateUnusedWhilePending;
+}
+
+bool PhysicalDevice::CheckDrawIndirectCountSupported() const {
+  const VkPhysicalDeviceFeatures device_features = GetFeatures();
+
+  return device_features.multiDrawIndirect &&
+         device_features.drawIndirectFirstInstance &&
+         CheckExtensionsSupport({VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME});
+}
+
+VkPhysicalDeviceProperties PhysicalDevice::GetProperties() const {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device_, &properties);
+
+  return properties;
+}
+
 } // namespace vk
\ No newline at end of file
@@ -28,6 +28,9 @@ public:
   [[nodiscard]] bool CheckExtensionsSupport(const std::vector<const char*>& extensions) const;
   [[nodiscard]] VkBool32 CheckSurfaceSupported(VkSurfaceKHR surface, uint32_t queue_family_idx) const;
   [[nodiscard]] VkPhysicalDeviceFeatures GetFeatures() const;
+  [[nodiscard]] bool CheckDescriptorIndexingSupported() const;
+  [[nodiscard]] bool CheckDrawIndirectCountSupported() const;
+  [[nodiscard]] VkPhysicalDeviceProperties GetProperties() const;
 private:
   VkPhysicalDevice physical_device_;
 };
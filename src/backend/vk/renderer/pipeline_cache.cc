@@ -0,0 +1,102 @@
+#include "backend/vk/renderer/pipeline_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "backend/vk/renderer/error.h"
+
+namespace vk {
+
+namespace {
+
+constexpr const char* kCacheDirName = "engine";
+constexpr const char* kCacheFileName = "vk_pipeline_cache.bin";
+
+struct CacheHeader {
+  uint32_t length;
+  uint32_t version;
+  uint32_t vendor_id;
+  uint32_t device_id;
+  uint8_t uuid[VK_UUID_SIZE];
+};
+
+bool CacheHeaderIsCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties) noexcept {
+  if (data.size() < sizeof(CacheHeader)) {
+    return false;
+  }
+  CacheHeader header = {};
+  std::memcpy(&header, data.data(), sizeof(CacheHeader));
+
+  return header.length >= sizeof(CacheHeader) &&
+         header.version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendor_id == properties.vendorID &&
+         header.device_id == properties.deviceID &&
+         std::memcmp(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+} // namespace
+
+std::filesystem::path PipelineCache::GetDefaultPath() {
+#ifdef _WIN32
+  if (const char* local_app_data = std::getenv("LOCALAPPDATA"); local_app_data != nullptr) {
+    return std::filesystem::path(local_app_data) / kCacheDirName / kCacheFileName;
+  }
+#else
+  if (const char* xdg_cache = std::getenv("XDG_CACHE_HOME"); xdg_cache != nullptr && *xdg_cache != '\0') {
+    return std::filesystem::path(xdg_cache) / kCacheDirName / kCacheFileName;
+  }
+  if (const char* home = std::getenv("HOME"); home != nullptr && *home != '\0') {
+    return std::filesystem::path(home) / ".cache" / kCacheDirName / kCacheFileName;
+  }
+#endif
+  return kCacheFileName;
+}
+
+std::vector<char> PipelineCache::ReadData(const std::filesystem::path& path, const VkPhysicalDeviceProperties& properties) {
+  std::ifstream file(path, std::ifstream::binary);
+  if (!file.is_open()) {
+    return {};
+  }
+  std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (!CacheHeaderIsCompatible(data, properties)) {
+    return {};
+  }
+  return data;
+}
+
+std::vector<char> PipelineCache::GetData() const {
+  size_t data_size = 0;
+  if (const VkResult result = vkGetPipelineCacheData(creator(), handle(), &data_size, nullptr); result != VK_SUCCESS) {
+    throw Error("failed to get pipeline cache size").WithCode(result);
+  }
+  std::vector<char> data(data_size);
+  if (const VkResult result = vkGetPipelineCacheData(creator(), handle(), &data_size, data.data()); result != VK_SUCCESS) {
+    throw Error("failed to get pipeline cache data").WithCode(result);
+  }
+  data.resize(data_size);
+  return data;
+}
+
+void PipelineCache::Write(const std::filesystem::path& path) const {
+  const std::vector<char> data = GetData();
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ofstream::binary | std::ofstream::trunc);
+    if (!file.is_open()) {
+      throw Error("failed to open pipeline cache file: " + tmp_path.string());
+    }
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+      throw Error("failed to write pipeline cache file: " + tmp_path.string());
+    }
+  }
+  std::filesystem::rename(tmp_path, path);
+}
+
+} // namespace vk
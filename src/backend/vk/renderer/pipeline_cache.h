@@ -0,0 +1,31 @@
+#ifndef BACKEND_VK_RENDERER_PIPELINE_CACHE_H_
+#define BACKEND_VK_RENDERER_PIPELINE_CACHE_H_
+
+#include <vulkan/vulkan.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "backend/vk/renderer/handle.h"
+
+namespace vk {
+
+class PipelineCache final : public DeviceHandle<VkPipelineCache> {
+public:
+  using DeviceHandle<VkPipelineCache>::DeviceHandle;
+
+  [[nodiscard]] static std::filesystem::path GetDefaultPath();
+  [[nodiscard]] static std::vector<char> ReadData(const std::filesystem::path& path, const VkPhysicalDeviceProperties& properties);
+
+  [[nodiscard]] std::vector<char> GetData() const;
+  void Write(const std::filesystem::path& path) const;
+private:
+  friend class Device;
+
+  explicit PipelineCache(DeviceHandle<VkPipelineCache>&& pipeline_cache) noexcept
+    : DeviceHandle<VkPipelineCache>(std::move(pipeline_cache)) {}
+};
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_PIPELINE_CACHE_H_
@@ -1,19 +1,35 @@
 #include "backend/vk/renderer/renderer.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
 
 #include "backend/vk/renderer/device_selector.h"
 #include "backend/vk/renderer/error.h"
 #include "backend/vk/renderer/object_loader.h"
 #include "backend/vk/renderer/shader.h"
-
-#include <thread>
+#include "trace/trace.h"
 
 namespace vk {
 
 namespace {
 
+constexpr uint32_t kMaxBindlessTextures = 256;
+// Below this many batches per thread, recording inline is cheaper than
+// handing the batches to the worker pool.
+constexpr size_t kBatchesPerRecordTask = 16;
+
+double Milliseconds(const std::chrono::steady_clock::duration duration) noexcept {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
 std::vector<const char*> GetInstanceExtensions(const Window& window) {
   std::vector<const char*> extensions = {
 #ifdef DEBUG
@@ -39,28 +55,100 @@ std::vector<const char*> GetInstanceLayers() {
   return layers;
 }
 
-std::vector<const char*> GetDeviceExtension() {
-  return {
-    VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+std::vector<const char*> GetDeviceExtension(const bool headless) {
+  std::vector<const char*> extensions = {
     VK_KHR_MAINTENANCE1_EXTENSION_NAME,
 #ifdef __APPLE__
     VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME
 #endif
   };
+  if (!headless) {
+    extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+  }
+  return extensions;
 }
 
 std::vector<const char*> GetDeviceLayers() {
   return GetInstanceLayers();
 }
 
+bool CachedCommandBuffersAreEnabled() noexcept {
+  const char* env = std::getenv("ENGINE_VK_CACHED_COMMANDS");
+  return env != nullptr && std::strcmp(env, "0") != 0;
+}
+
+// Directory the frames of a headless window are written to, if any.
+std::filesystem::path GetReadbackDir() {
+  const char* env = std::getenv("ENGINE_VK_READBACK_DIR");
+  return env != nullptr ? env : std::filesystem::path();
+}
+
+size_t RecordThreadCount() noexcept {
+  if (const char* env = std::getenv("ENGINE_VK_RECORD_THREADS"); env != nullptr) {
+    return std::max<size_t>(std::strtoul(env, nullptr, 10), 1);
+  }
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+// Present modes to try in order for the requested policy.
+std::vector<VkPresentModeKHR> GetPresentModes(const engine::PresentMode present_mode) {
+  switch (present_mode) {
+    case engine::PresentMode::kFifo:
+      return {VK_PRESENT_MODE_FIFO_KHR};
+    case engine::PresentMode::kFifoRelaxed:
+      return {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+    case engine::PresentMode::kMailbox:
+      return {VK_PRESENT_MODE_MAILBOX_KHR};
+    case engine::PresentMode::kImmediate:
+      return {VK_PRESENT_MODE_IMMEDIATE_KHR};
+    case engine::PresentMode::kLowestLatency:
+      return {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+  }
+  return {};
+}
+
+// Grows a persistently mapped buffer to hold at least size bytes. Only
+// called for the current frame, after its fence has been waited on. Returns
+// whether the buffer was reallocated.
+bool ReserveMappedBuffer(const Device& device, Buffer& buffer, void*& mapped, const VkBufferUsageFlags usage, const VkDeviceSize size) {
+  if (buffer.handle() != VK_NULL_HANDLE && buffer.size() >= size) {
+    return false;
+  }
+  const VkDeviceSize capacity = std::max<VkDeviceSize>(size, 2 * buffer.size());
+  buffer = device.CreateBuffer(
+    usage,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+    capacity
+  );
+  mapped = buffer.memory().Map();
+  return true;
+}
+
 } // namespace
 
-Renderer::Renderer(Window& window, const size_t frame_count)
+Renderer::Renderer(Window& window, const engine::RendererOptions& options)
   : window_(window),
-    frame_count_(frame_count),
+    headless_(window.IsHeadless()),
+    frame_count_(std::max<size_t>(options.frames_in_flight, 1)),
+    present_modes_(GetPresentModes(options.present_mode)),
+    swapchain_image_count_(options.swapchain_images),
     framebuffer_resized_(false),
+    defer_recreation_(options.render_thread && !headless_),
+    surface_out_of_date_(false),
     curr_frame_(0),
-    instance_(GetInstanceExtensions(window), GetInstanceLayers()) {
+    instance_(GetInstanceExtensions(window), GetInstanceLayers()),
+    frame_serial_(0),
+    frame_serials_(frame_count_, 0),
+    readback_dir_(headless_ ? GetReadbackDir() : std::filesystem::path()),
+    present_time_(0.0),
+    record_pool_(RecordThreadCount()),
+    cached_commands_(CachedCommandBuffersAreEnabled()),
+    commands_version_(1),
+    scene_layout_version_(0),
+    cull_uniforms_version_(0),
+    cull_pyramid_ready_(false),
+    draw_stats_(),
+    gpu_culling_(false) {
   ObjectLoader::Init();
 
   window.SetWindowResizedCallback([this]([[maybe_unused]] int width, [[maybe_unused]] int height) {
@@ -70,14 +158,15 @@ Renderer::Renderer(Window& window, const size_t frame_count)
   messenger_ = instance_.CreateMessenger();
 #endif
 
-  surface_ = instance_.CreateSurface(window);
-
+  if (!headless_) {
+    surface_ = instance_.CreateSurface(window);
+  }
   DeviceSelector::Requirements requirements = {};
-  requirements.present = true;
+  requirements.present = !headless_;
   requirements.graphic = true;
   requirements.anisotropy = true;
   requirements.surface = surface_.handle();
-  requirements.extensions = GetDeviceExtension();
+  requirements.extensions = GetDeviceExtension(headless_);
   requirements.layers = GetDeviceLayers();
 
   const std::vector<VkPhysicalDevice> devices = instance_.EnumerateDevices();
@@ -87,62 +176,192 @@ Renderer::Renderer(Window& window, const size_t frame_count)
     throw Error("failed to find suitable device");
   }
   device_ = std::move(*device);
+  const VkPhysicalDeviceFeatures device_features = device_.physical_device().GetFeatures();
+  multi_draw_indirect_ = device_features.multiDrawIndirect == VK_TRUE && device_features.drawIndirectFirstInstance == VK_TRUE;
+  gpu_culling_ = options.gpu_culling && GpuCuller::IsSupported(device_.physical_device());
+
+  material_layout_.next_element = 0;
+  material_layout_.bindless = options.bindless && device_.physical_device().CheckDescriptorIndexingSupported();
+  if (material_layout_.bindless) {
+    const VkPhysicalDeviceLimits limits = device_.physical_device().GetProperties().limits;
+    material_layout_.descriptor_count = std::min({kMaxBindlessTextures,
+                                                  limits.maxPerStageDescriptorSamplers,
+                                                  limits.maxPerStageDescriptorSampledImages,
+                                                  limits.maxDescriptorSetSamplers});
+    // Meshes loaded later write elements no recorded draw reads yet, which
+    // frames still in flight must not be invalidated by.
+    material_layout_.layout = device_.CreateSamplerDescriptorSetLayout(material_layout_.descriptor_count,
+                                                                       VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+                                                                       VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT);
+    material_layout_.descriptor_pool = device_.CreateDescriptorPool(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, material_layout_.descriptor_count);
+    material_layout_.descriptor_set = device_.CreateDescriptorSets(material_layout_.layout.handle(), material_layout_.descriptor_pool.handle(), 1).front();
+  } else {
+    material_layout_.descriptor_count = 1;
+    material_layout_.layout = device_.CreateSamplerDescriptorSetLayout();
+    material_layout_.descriptor_set = VK_NULL_HANDLE;
+  }
 
-  std::tie(swapchain_, depth_image_) = CreateSwapchainAndDepthImage();
-  render_pass_ = device_.CreateRenderPass(swapchain_.format(),  depth_image_.format());
-  std::tie(swapchain_framebuffers_, sync_objects_) = CreateSwapchainImagesAndSyncObjects();
+  if (options.gpu_profiler && GpuProfiler::IsSupported(device_.physical_device())) {
+    profiler_ = GpuProfiler(device_, frame_count_);
+  }
+
+  if (options.pipeline_cache) {
+    pipeline_cache_path_ = PipelineCache::GetDefaultPath();
+    pipeline_cache_ = device_.CreatePipelineCache(PipelineCache::ReadData(pipeline_cache_path_, device_.physical_device().GetProperties()));
+  }
+
+  // The depth pyramid is reduced from the stored depth after the pass.
+  const VkAttachmentStoreOp depth_store_op = gpu_culling_ ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  if (headless_) {
+    VkExtent2D extent = {};
+    extent.width = window_.GetWidth();
+    extent.height = window_.GetHeight();
+
+    offscreen_ = OffscreenTarget(device_, extent, frame_count_, !readback_dir_.empty());
+    depth_image_ = CreateDepthImage(extent);
+    render_pass_ = device_.CreateRenderPass(OffscreenTarget::kFormat, depth_image_.format(), depth_store_op,
+                                            offscreen_.readback() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  } else {
+    std::tie(swapchain_, depth_image_) = CreateSwapchainAndDepthImage();
+    render_pass_ = device_.CreateRenderPass(swapchain_.format(), depth_image_.format(), depth_store_op);
+  }
+  swapchain_framebuffers_ = CreateSwapchainFramebuffers();
+  sync_objects_ = CreateSyncObjects();
 
   cmd_pool_ = device_.CreateCommandPool();
   cmd_buffers_ = device_.CreateCommandBuffers(cmd_pool_.handle(), frame_count_);
+
+  record_workers_.resize(record_pool_.size());
+  for(RecordWorker& worker : record_workers_) {
+    for(size_t i = 0; i < frame_count_; ++i) {
+      worker.cmd_pools.push_back(device_.CreateCommandPool());
+      worker.cmd_buffers.push_back(device_.CreateCommandBuffers(worker.cmd_pools.back().handle(), 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY).front());
+    }
+  }
+  if (cached_commands_) {
+    CreateCachedCommandBuffers();
+  }
+
+  uniform_descriptor_ = CreateUniformDescriptor();
+  uniforms_buff_.reserve(frame_count_);
+  for(const UniformDescriptorSet& descriptor_set : uniform_descriptor_.sets) {
+    uniforms_buff_.emplace_back(static_cast<Uniforms*>(descriptor_set.buffer.memory().Map()));
+  }
+  uniforms_versions_.assign(frame_count_, 0);
+
+  frame_draws_.resize(frame_count_);
+
+  CreatePipeline();
+
+  if (gpu_culling_) {
+    culler_ = GpuCuller(device_, pipeline_cache_.handle(), frame_count_);
+    culler_.SetDepthImage(depth_image_, deletion_queue_);
+  }
 }
 
-Renderer::~Renderer() { vkDeviceWaitIdle(device_.handle()); }
+Renderer::~Renderer() {
+  vkDeviceWaitIdle(device_.handle());
+  try {
+    for(size_t frame = 0; frame < frame_count_; ++frame) {
+      WriteReadback(frame);
+    }
+  } catch (const std::exception& error) {
+    std::cerr << "failed to write readback: " << error.what() << std::endl;
+  }
+  if (pipeline_cache_.handle() == VK_NULL_HANDLE) {
+    return;
+  }
+  try {
+    pipeline_cache_.Write(pipeline_cache_path_);
+  } catch (const std::exception& error) {
+    std::cerr << "failed to save pipeline cache: " << error.what() << std::endl;
+  }
+}
 
 void Renderer::RenderFrame() {
-  uint32_t image_idx;
+  TRACE_ZONE("Renderer::RenderFrame");
+  // Offscreen images are owned by their frame slot, nothing is acquired.
+  auto image_idx = static_cast<uint32_t>(curr_frame_);
 
   VkFence fence = sync_objects_[curr_frame_].fence.handle();
   VkSemaphore wait_semaphore = sync_objects_[curr_frame_].image_semaphore.handle();
   VkSemaphore signal_semaphore = sync_objects_[curr_frame_].render_semaphore.handle();
 
-  VkCommandBuffer cmd_buffer = cmd_buffers_[curr_frame_];
   VkSwapchainKHR swapchain = swapchain_.handle();
 
-  if (const VkResult result = vkWaitForFences(device_.handle(), 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()); result != VK_SUCCESS) {
-    throw Error("failed to wait for fences").WithCode(result);
-  }
-  if (const VkResult result = vkAcquireNextImageKHR(device_.handle(), swapchain_.handle(), std::numeric_limits<uint64_t>::max(), wait_semaphore, VK_NULL_HANDLE, &image_idx); result != VK_SUCCESS) {
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-      RecreateSwapchain();
-      return;
+  {
+    TRACE_ZONE("wait for fence");
+    if (const VkResult result = vkWaitForFences(device_.handle(), 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()); result != VK_SUCCESS) {
+      throw Error("failed to wait for fences").WithCode(result);
     }
-    throw Error("failed to acquire next image").WithCode(result);
+  }
+  // Submissions complete in order, so every frame up to this one is done.
+  deletion_queue_.Collect(frame_serials_[curr_frame_]);
+  if (profiler_.enabled()) {
+    profiler_.Read(curr_frame_);
+  }
+  WriteReadback(curr_frame_);
+
+  VkResult acquire_result = VK_SUCCESS;
+  present_time_ = 0.0;
+  if (!headless_) {
+    TRACE_ZONE("acquire");
+    const auto acquire_begin = std::chrono::steady_clock::now();
+    acquire_result = vkAcquireNextImageKHR(device_.handle(), swapchain_.handle(), std::numeric_limits<uint64_t>::max(), wait_semaphore, VK_NULL_HANDLE, &image_idx);
+    present_time_ = Milliseconds(std::chrono::steady_clock::now() - acquire_begin);
+  }
+  if (acquire_result == VK_ERROR_OUT_OF_DATE_KHR) {
+    OnSwapchainOutOfDate();
+    return;
+  }
+  // A suboptimal image has still been acquired and its semaphore will be
+  // signaled, so it is rendered and presented before recreating.
+  if (acquire_result != VK_SUCCESS && acquire_result != VK_SUBOPTIMAL_KHR) {
+    throw Error("failed to acquire next image").WithCode(acquire_result);
   }
   UpdateUniforms();
+  PrepareDraws();
+  if (profiler_.enabled()) {
+    PrepareProfiler();
+  }
   if (const VkResult result = vkResetFences(device_.handle(), 1, &fence); result != VK_SUCCESS) {
     throw Error("failed to reset fences").WithCode(result);
   }
-  if (const VkResult result = vkResetCommandBuffer(cmd_buffer, 0); result != VK_SUCCESS) {
-    throw Error("failed to reset command buffer").WithCode(result);
-  }
-  RecordCommandBuffer(cmd_buffer, image_idx);
+  VkCommandBuffer cmd_buffer = PrepareCommandBuffer(image_idx);
 
   const std::vector<VkPipelineStageFlags> pipeline_stages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
   VkSubmitInfo submit_info = {};
   submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submit_info.waitSemaphoreCount = 1;
-  submit_info.pWaitSemaphores = &wait_semaphore;
-  submit_info.pWaitDstStageMask = pipeline_stages.data();
   submit_info.commandBufferCount = 1;
   submit_info.pCommandBuffers = &cmd_buffer;
-  submit_info.signalSemaphoreCount = 1;
-  submit_info.pSignalSemaphores = &signal_semaphore;
+  if (!headless_) {
+    submit_info.waitSemaphoreCount = 1;
+    submit_info.pWaitSemaphores = &wait_semaphore;
+    submit_info.pWaitDstStageMask = pipeline_stages.data();
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &signal_semaphore;
+  }
 
   if (const VkResult result = vkQueueSubmit(device_.graphics_queue().handle, 1, &submit_info, fence); result != VK_SUCCESS) {
     throw Error("failed to submit draw command buffer").WithCode(result);
   }
+  frame_serials_[curr_frame_] = ++frame_serial_;
+  deletion_queue_.SetSubmittedSerial(frame_serial_);
+  // Acquiring from the new swapchain means the presentation engine is done
+  // with the retired ones by the time this frame completes.
+  for(Swapchain& retired_swapchain : retired_swapchains_) {
+    deletion_queue_.Push(std::move(retired_swapchain));
+  }
+  retired_swapchains_.clear();
+  if (profiler_.enabled()) {
+    profiler_.Submit(curr_frame_);
+  }
 
+  if (headless_) {
+    curr_frame_ = (curr_frame_ + 1) % frame_count_;
+    return;
+  }
   VkPresentInfoKHR present_info = {};
   present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
   present_info.waitSemaphoreCount = 1;
@@ -151,24 +370,38 @@ void Renderer::RenderFrame() {
   present_info.pSwapchains = &swapchain;
   present_info.pImageIndices = &image_idx;
 
-  if (const VkResult result = vkQueuePresentKHR(device_.present_queue().handle, &present_info);
-      result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebuffer_resized_) {
+  VkResult result;
+  {
+    TRACE_ZONE("present");
+    const auto present_begin = std::chrono::steady_clock::now();
+    result = vkQueuePresentKHR(device_.present_queue().handle, &present_info);
+    present_time_ += Milliseconds(std::chrono::steady_clock::now() - present_begin);
+  }
+  if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || acquire_result == VK_SUBOPTIMAL_KHR || framebuffer_resized_) {
     framebuffer_resized_ = false;
-    RecreateSwapchain();
+    OnSwapchainOutOfDate();
   } else if (result != VK_SUCCESS) {
     throw Error("failed to queue present").WithCode(result);
   }
   curr_frame_ = (curr_frame_ + 1) % frame_count_;
 }
 
-void Renderer::LoadModel(const std::string& path) {
-  object_ = ObjectLoader(device_, cmd_pool_.handle()).Load(path, frame_count_);
+engine::MeshId Renderer::LoadMesh(const std::string& path) {
+  meshes_.push_back(ObjectLoader(device_, cmd_pool_.handle(), texture_cache_, sampler_cache_, material_layout_).Load(path, material_layout_.next_element));
+  if (material_layout_.bindless) {
+    material_layout_.next_element += static_cast<uint32_t>(meshes_.back().sampler_descriptor.sets.size());
+  }
+  InvalidateCommandBuffers();
+
+  return static_cast<engine::MeshId>(meshes_.size() - 1);
+}
 
-  const std::vector descriptor_set_layouts = { object_.uniform_descriptor.layout.handle(), object_.sampler_descriptor.layout.handle() };
+void Renderer::CreatePipeline() {
+  const std::vector descriptor_set_layouts = { uniform_descriptor_.layout.handle(), material_layout_.layout.handle() };
 
-  pipeline_layout_ = device_.CreatePipelineLayout(descriptor_set_layouts);
+  pipeline_layout_ = device_.CreatePipelineLayout(descriptor_set_layouts, {});
 
-  const std::vector<ShaderInfo> shader_infos = Shader::GetInfos();
+  const std::vector<ShaderInfo> shader_infos = Shader::GetInfos(material_layout_.bindless ? ShaderVariant::kBindless : ShaderVariant::kSimple);
 
   std::vector<Shader> shaders;
   shaders.reserve(shader_infos.size());
@@ -179,25 +412,82 @@ void Renderer::LoadModel(const std::string& path) {
 
     shaders.emplace_back(std::move(shader));
   }
-  pipeline_ = device_.CreatePipeline(pipeline_layout_.handle(), render_pass_.handle(), Vertex::GetAttributeDescriptions(), Vertex::GetBindingDescriptions(), shaders);
+  std::vector<VkVertexInputAttributeDescription> attribute_descriptions = Vertex::GetAttributeDescriptions();
+  std::vector<VkVertexInputBindingDescription> binding_descriptions = Vertex::GetBindingDescriptions();
 
-  uniforms_buff_.reserve(object_.uniform_descriptor.sets.size());
-  for(const UniformDescriptorSet& descriptor_set : object_.uniform_descriptor.sets) {
-    auto uniforms = static_cast<Uniforms*>(descriptor_set.buffer.memory().Map());
-    uniforms_buff_.emplace_back(uniforms);
+  const auto append_descriptions = [&](const std::vector<VkVertexInputAttributeDescription>& attributes,
+                                       const std::vector<VkVertexInputBindingDescription>& bindings) {
+    attribute_descriptions.insert(attribute_descriptions.end(), attributes.begin(), attributes.end());
+    binding_descriptions.insert(binding_descriptions.end(), bindings.begin(), bindings.end());
+  };
+  if (material_layout_.bindless) {
+    append_descriptions(VertexMaterial::GetAttributeDescriptions(), VertexMaterial::GetBindingDescriptions());
   }
+  append_descriptions(InstanceTransform::GetAttributeDescriptions(), InstanceTransform::GetBindingDescriptions());
+
+  {
+    // Shows what the pipeline cache saves, compared with a trace taken with
+    // ENGINE_PIPELINE_CACHE=0.
+    TRACE_ZONE("create pipeline");
+    pipeline_ = device_.CreatePipeline(pipeline_cache_.handle(), pipeline_layout_.handle(), render_pass_.handle(), attribute_descriptions, binding_descriptions, shaders);
+  }
+  InvalidateCommandBuffers();
+}
+
+bool Renderer::IsSurfaceOutOfDate() const noexcept {
+  return surface_out_of_date_ || (defer_recreation_ && framebuffer_resized_);
 }
 
+void Renderer::RecreateSurface() {
+  surface_out_of_date_ = false;
+  framebuffer_resized_ = false;
+  RecreateSwapchain();
+}
+
+void Renderer::OnSwapchainOutOfDate() {
+  if (defer_recreation_) {
+    surface_out_of_date_ = true;
+  } else {
+    RecreateSwapchain();
+  }
+}
+
+// Frames in flight may still render to the old images, so instead of idling
+// the device everything replaced here is retired to the deletion queue, the
+// swapchain itself only after the next acquire. The sync objects do not
+// depend on the swapchain and are kept.
 void Renderer::RecreateSwapchain() {
   window_.WaitUntilResized();
 
-  if (const VkResult result = vkDeviceWaitIdle(device_.handle()); result != VK_SUCCESS) {
-    throw Error("failed to idle device");
+  auto[swapchain, depth_image] = CreateSwapchainAndDepthImage();
+  deletion_queue_.Push(std::move(swapchain_framebuffers_));
+  deletion_queue_.Push(std::move(depth_image_));
+  retired_swapchains_.push_back(std::move(swapchain_));
+  swapchain_ = std::move(swapchain);
+  depth_image_ = std::move(depth_image);
+  swapchain_framebuffers_ = CreateSwapchainFramebuffers();
+
+  if (gpu_culling_) {
+    culler_.SetDepthImage(depth_image_, deletion_queue_);
+  }
+  if (cached_commands_) {
+    deletion_queue_.Push(std::move(cached_cmd_pool_));
+    CreateCachedCommandBuffers();
   }
-  swapchain_ = Swapchain();
+  InvalidateCommandBuffers();
+}
+
+// Allocates one primary command buffer per frame slot and swapchain image.
+// Replacing the pool frees the buffers recorded for the previous swapchain.
+void Renderer::CreateCachedCommandBuffers() {
+  cached_cmd_pool_ = device_.CreateCommandPool();
+  const std::vector<VkCommandBuffer> cmd_buffers = device_.CreateCommandBuffers(cached_cmd_pool_.handle(), static_cast<uint32_t>(frame_count_ * swapchain_framebuffers_.size()));
 
-  std::tie(swapchain_, depth_image_) = CreateSwapchainAndDepthImage();
-  std::tie(swapchain_framebuffers_, sync_objects_) = CreateSwapchainImagesAndSyncObjects();
+  cached_cmd_buffers_.clear();
+  cached_cmd_buffers_.reserve(cmd_buffers.size());
+  for(VkCommandBuffer cmd_buffer : cmd_buffers) {
+    cached_cmd_buffers_.push_back({cmd_buffer, 0});
+  }
 }
 
 std::pair<Swapchain, Image> Renderer::CreateSwapchainAndDepthImage() const {
@@ -205,24 +495,46 @@ std::pair<Swapchain, Image> Renderer::CreateSwapchainAndDepthImage() const {
   swapchain_extent.width = window_.GetWidth();
   swapchain_extent.height = window_.GetHeight();
 
-  Swapchain swapchain = device_.CreateSwapchain(swapchain_extent, surface_.handle());
+  Swapchain swapchain = device_.CreateSwapchain(swapchain_extent, surface_.handle(), present_modes_, swapchain_image_count_, swapchain_.handle());
+  Image depth_image = CreateDepthImage(swapchain.extent());
+
+  return { std::move(swapchain), std::move(depth_image) };
+}
 
+Image Renderer::CreateDepthImage(const VkExtent2D extent) const {
+  VkFormatFeatureFlags depth_features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+  VkImageUsageFlags depth_usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+  if (gpu_culling_) {
+    depth_features |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    depth_usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+  }
   const VkFormat depth_format = device_.physical_device().FindSupportedFormat(
       {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
                 VK_IMAGE_TILING_OPTIMAL,
-                VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+                depth_features
   );
-  Image depth_image = device_.CreateImage(
-    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+  return device_.CreateImage(
+    depth_usage,
     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-    VK_IMAGE_ASPECT_DEPTH_BIT, swapchain.extent(),
+    VK_IMAGE_ASPECT_DEPTH_BIT, extent,
     depth_format,
     VK_IMAGE_TILING_OPTIMAL
   );
-  return { std::move(swapchain), std::move(depth_image) };
 }
 
-std::pair<std::vector<SwapchainFramebuffer>, std::vector<SyncObject>> Renderer::CreateSwapchainImagesAndSyncObjects() const {
+std::vector<SwapchainFramebuffer> Renderer::CreateSwapchainFramebuffers() const {
+  if (headless_) {
+    std::vector<SwapchainFramebuffer> offscreen_framebuffers;
+    offscreen_framebuffers.reserve(offscreen_.images().size());
+
+    for(const Image& image : offscreen_.images()) {
+      SwapchainFramebuffer offscreen_framebuffer = {};
+      offscreen_framebuffer.framebuffer = device_.CreateFramebuffer({image.view(), depth_image_.view()}, render_pass_.handle(), offscreen_.extent());
+
+      offscreen_framebuffers.emplace_back(std::move(offscreen_framebuffer));
+    }
+    return offscreen_framebuffers;
+  }
   const std::vector<VkImage> images = swapchain_.images();
   std::vector<SwapchainFramebuffer> swapchain_framebuffers;
   swapchain_framebuffers.reserve(images.size());
@@ -234,6 +546,10 @@ std::pair<std::vector<SwapchainFramebuffer>, std::vector<SyncObject>> Renderer::
 
     swapchain_framebuffers.emplace_back(std::move(swapchain_framebuffer));
   }
+  return swapchain_framebuffers;
+}
+
+std::vector<SyncObject> Renderer::CreateSyncObjects() const {
   std::vector<SyncObject> sync_objects;
   sync_objects.reserve(frame_count_);
 
@@ -246,12 +562,185 @@ std::pair<std::vector<SwapchainFramebuffer>, std::vector<SyncObject>> Renderer::
     sync_objects.emplace_back(std::move(sync_object));
   }
 
-  return { std::move(swapchain_framebuffers), std::move(sync_objects) };
+  return sync_objects;
+}
+
+UniformDescriptor Renderer::CreateUniformDescriptor() const {
+  UniformDescriptor uniform_descriptor = {};
+  uniform_descriptor.layout = device_.CreateUniformDescriptorSetLayout();
+  uniform_descriptor.descriptor_pool = device_.CreateDescriptorPool(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frame_count_);
+  const std::vector<VkDescriptorSet> descriptor_sets = device_.CreateDescriptorSets(uniform_descriptor.layout.handle(), uniform_descriptor.descriptor_pool.handle(), frame_count_);
+
+  uniform_descriptor.sets.reserve(frame_count_);
+  for(VkDescriptorSet descriptor_set : descriptor_sets) {
+    UniformDescriptorSet uniform_descriptor_set = {};
+    uniform_descriptor_set.buffer = device_.CreateBuffer(
+      VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      sizeof(Uniforms)
+    );
+    uniform_descriptor_set.handle = descriptor_set;
+    uniform_descriptor_set.Update();
+
+    uniform_descriptor.sets.emplace_back(std::move(uniform_descriptor_set));
+  }
+  return uniform_descriptor;
 }
 
-inline void Renderer::UpdateUniforms() const {
-  const engine::Uniforms& uniforms = model_.GetUniforms();
+inline void Renderer::UpdateUniforms() {
+  const uint64_t version = scene_.GetUniformsVersion();
+  if (uniforms_versions_[curr_frame_] == version) {
+    return;
+  }
+  const engine::Uniforms& uniforms = scene_.GetUniforms();
   std::memcpy(uniforms_buff_[curr_frame_], &uniforms, sizeof(Uniforms));
+  uniforms_versions_[curr_frame_] = version;
+}
+
+// Only the slots changed since the frame slot was last prepared are
+// recomputed, and its transforms and draw commands are only rewritten when
+// the scene changed since, so a static scene costs next to nothing here.
+void Renderer::PrepareDraws() {
+  scene_.UpdateTransforms();
+  const uint64_t layout_version = scene_.GetLayoutVersion();
+  if (layout_version != scene_layout_version_) {
+    scene_layout_version_ = layout_version;
+    InvalidateCommandBuffers();
+    BuildDraws();
+  }
+
+  const engine::Uniforms& uniforms = scene_.GetUniforms();
+  const glm::mat4 view_proj = uniforms.proj * uniforms.view;
+  FrameDraws& frame_draws = frame_draws_[curr_frame_];
+  const size_t instance_count = scene_.GetObjectCount() + scene_.GetInstanceCount();
+  if (instance_count == 0) {
+    if (gpu_culling_ && culler_.Prepare(curr_frame_, cull_items_, layout_version, 0, frame_draws.transforms, view_proj)) {
+      InvalidateCommandBuffers();
+    }
+    return;
+  }
+  // The culling shader reads the transforms as a storage buffer.
+  const VkBufferUsageFlags transforms_usage = gpu_culling_ ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+  const bool transforms_reallocated = ReserveMappedBuffer(device_, frame_draws.transforms, frame_draws.mapped_transforms, transforms_usage, sizeof(InstanceTransform) * instance_count);
+  if (transforms_reallocated) {
+    InvalidateCommandBuffers();
+  }
+  if (const uint64_t transforms_version = scene_.GetTransformsVersion(); transforms_reallocated || frame_draws.transforms_version != transforms_version) {
+    scene_.CopyTransforms(static_cast<glm::mat4*>(frame_draws.mapped_transforms));
+    frame_draws.transforms_version = transforms_version;
+  }
+
+  if (gpu_culling_) {
+    if (culler_.Prepare(curr_frame_, cull_items_, layout_version, static_cast<uint32_t>(draw_batches_.size()), frame_draws.transforms, view_proj)) {
+      InvalidateCommandBuffers();
+    }
+    return;
+  }
+  if (multi_draw_indirect_ && !draw_commands_.empty()) {
+    const VkDeviceSize commands_size = sizeof(VkDrawIndexedIndirectCommand) * draw_commands_.size();
+    const bool commands_reallocated = ReserveMappedBuffer(device_, frame_draws.commands, frame_draws.mapped_commands, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, commands_size);
+    if (commands_reallocated) {
+      InvalidateCommandBuffers();
+    }
+    if (commands_reallocated || frame_draws.layout_version != layout_version) {
+      std::memcpy(frame_draws.mapped_commands, draw_commands_.data(), commands_size);
+      frame_draws.layout_version = layout_version;
+    }
+  }
+}
+
+// Rebuilds the draw commands, batches and cull items of the scene layout.
+void Renderer::BuildDraws() {
+  draw_commands_.clear();
+  draw_batches_.clear();
+  cull_items_.clear();
+  draw_stats_ = {};
+
+  mesh_instances_.resize(meshes_.size());
+  scene_.CollectInstanceRanges(mesh_instances_);
+
+  for(engine::MeshId mesh = 0; mesh < meshes_.size(); ++mesh) {
+    const std::vector<engine::InstanceRange>& instances = mesh_instances_[mesh];
+    if (instances.empty()) {
+      continue;
+    }
+    const Object& object = meshes_[mesh];
+    for(const auto[material, first_command, command_count] : object.draw_groups) {
+      if (gpu_culling_) {
+        AppendCullItems(object, first_command, command_count, instances, mesh, material);
+        continue;
+      }
+      DrawBatch batch = {mesh, material, static_cast<uint32_t>(draw_commands_.size()), 0};
+      for(uint32_t i = first_command; i < first_command + command_count; ++i) {
+        for(const auto[first_instance, instance_count] : instances) {
+          VkDrawIndexedIndirectCommand command = object.draw_commands[i];
+          command.firstInstance = first_instance;
+          command.instanceCount = instance_count;
+          draw_commands_.push_back(command);
+          draw_stats_.drawn += instance_count;
+        }
+      }
+      batch.command_count = static_cast<uint32_t>(draw_commands_.size()) - batch.first_command;
+      draw_batches_.push_back(batch);
+    }
+  }
+}
+
+// Expands every instance of the given draw commands into a cull item whose
+// output slots form one new draw batch.
+void Renderer::AppendCullItems(const Object& object, const uint32_t first_command, const uint32_t command_count,
+                               const std::vector<engine::InstanceRange>& instances, const engine::MeshId mesh, const uint32_t material) {
+  DrawBatch batch = {mesh, material, static_cast<uint32_t>(cull_items_.size()), 0};
+  const auto batch_idx = static_cast<uint32_t>(draw_batches_.size());
+
+  for(uint32_t i = first_command; i < first_command + command_count; ++i) {
+    const VkDrawIndexedIndirectCommand& command = object.draw_commands[i];
+    for(const auto[first_instance, instance_count] : instances) {
+      for(uint32_t instance = first_instance; instance < first_instance + instance_count; ++instance) {
+        CullItem item = {};
+        item.sphere = object.draw_bounds[i];
+        item.index_count = command.indexCount;
+        item.first_index = command.firstIndex;
+        item.vertex_offset = command.vertexOffset;
+        item.instance = instance;
+        item.batch = batch_idx;
+        item.first_command = batch.first_command;
+        cull_items_.push_back(item);
+      }
+    }
+  }
+  batch.command_count = static_cast<uint32_t>(cull_items_.size()) - batch.first_command;
+  draw_batches_.push_back(batch);
+}
+
+// Returns the command buffer to submit this frame. Without cached command
+// buffers the frame's buffer is re-recorded every time, otherwise the one of
+// this frame slot and image is only re-recorded once it is out of date.
+VkCommandBuffer Renderer::PrepareCommandBuffer(const size_t image_idx) {
+  VkCommandBuffer cmd_buffer = cmd_buffers_[curr_frame_];
+  CachedCommandBuffer* cached = nullptr;
+  if (cached_commands_) {
+    // The culling pass bakes in the view projection and whether a depth
+    // pyramid has been built yet.
+    if (gpu_culling_ && (scene_.GetUniformsVersion() != cull_uniforms_version_ || culler_.pyramid_ready() != cull_pyramid_ready_)) {
+      cull_uniforms_version_ = scene_.GetUniformsVersion();
+      cull_pyramid_ready_ = culler_.pyramid_ready();
+      InvalidateCommandBuffers();
+    }
+    cached = &cached_cmd_buffers_[curr_frame_ * swapchain_framebuffers_.size() + image_idx];
+    if (cached->version == commands_version_) {
+      return cached->handle;
+    }
+    cmd_buffer = cached->handle;
+  }
+  if (const VkResult result = vkResetCommandBuffer(cmd_buffer, 0); result != VK_SUCCESS) {
+    throw Error("failed to reset command buffer").WithCode(result);
+  }
+  RecordCommandBuffer(cmd_buffer, image_idx);
+  if (cached != nullptr) {
+    cached->version = commands_version_;
+  }
+  return cmd_buffer;
 }
 
 void Renderer::RecordCommandBuffer(VkCommandBuffer cmd_buffer, const size_t image_idx) {
@@ -260,6 +749,14 @@ void Renderer::RecordCommandBuffer(VkCommandBuffer cmd_buffer, const size_t imag
   if (const VkResult result = vkBeginCommandBuffer(cmd_buffer, &cmd_buffer_begin_info); result != VK_SUCCESS) {
     throw Error("failed to begin recording command buffer").WithCode(result);
   }
+  if (profiler_.enabled()) {
+    profiler_.RecordBegin(cmd_buffer, curr_frame_);
+  }
+  if (gpu_culling_) {
+    const engine::Uniforms& uniforms = scene_.GetUniforms();
+    culler_.RecordCull(cmd_buffer, curr_frame_, uniforms.proj * uniforms.view);
+    RecordPassEnd(cmd_buffer, "cull");
+  }
   std::array<VkClearValue, 2> clear_values = {};
   clear_values[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
   clear_values[1].depthStencil = {1.0f, 0};
@@ -269,45 +766,171 @@ void Renderer::RecordCommandBuffer(VkCommandBuffer cmd_buffer, const size_t imag
   render_pass_begin_info.renderPass = render_pass_.handle();
   render_pass_begin_info.framebuffer = swapchain_framebuffers_[image_idx].framebuffer.handle();
   render_pass_begin_info.renderArea.offset = {0, 0};
-  render_pass_begin_info.renderArea.extent = swapchain_.extent();
+  render_pass_begin_info.renderArea.extent = GetExtent();
   render_pass_begin_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
   render_pass_begin_info.pClearValues = clear_values.data();
-  vkCmdBeginRenderPass(cmd_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+  // Secondary buffers are re-recorded per frame slot regardless of the image,
+  // which would invalidate the other cached primaries of the slot.
+  const size_t task_count = cached_commands_ ? 1 : std::min(record_pool_.size(), (draw_batches_.size() + kBatchesPerRecordTask - 1) / kBatchesPerRecordTask);
+  if (task_count > 1) {
+    vkCmdBeginRenderPass(cmd_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    std::vector<VkCommandBuffer> secondary_cmd_buffers(task_count);
+    record_pool_.Run(task_count, [&](const size_t task) {
+      secondary_cmd_buffers[task] = RecordSecondaryCommandBuffer(task, task_count, image_idx);
+    });
+    vkCmdExecuteCommands(cmd_buffer, static_cast<uint32_t>(secondary_cmd_buffers.size()), secondary_cmd_buffers.data());
+  } else {
+    vkCmdBeginRenderPass(cmd_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    RecordDraws(cmd_buffer, 0, draw_batches_.size());
+  }
+  vkCmdEndRenderPass(cmd_buffer);
+  RecordPassEnd(cmd_buffer, "draw");
+  if (gpu_culling_) {
+    culler_.RecordDepthPyramid(cmd_buffer, depth_image_.handle());
+    RecordPassEnd(cmd_buffer, "depth pyramid");
+  }
+  if (offscreen_.readback()) {
+    offscreen_.RecordReadback(cmd_buffer, image_idx);
+    RecordPassEnd(cmd_buffer, "readback");
+  }
+  if (const VkResult result = vkEndCommandBuffer(cmd_buffer); result != VK_SUCCESS) {
+    throw Error("failed to record command buffer").WithCode(result);
+  }
+}
+
+// Hands this frame's draw groups to the profiler, one per draw batch.
+void Renderer::PrepareProfiler() {
+  profiled_groups_.clear();
+  for(const DrawBatch& batch : draw_batches_) {
+    profiled_groups_.push_back({batch.mesh, batch.material, 0.0});
+  }
+  if (profiler_.Prepare(curr_frame_, profiled_groups_)) {
+    InvalidateCommandBuffers();
+  }
+}
+
+void Renderer::RecordPassEnd(VkCommandBuffer cmd_buffer, const char* name) {
+  if (profiler_.enabled()) {
+    profiler_.RecordPassEnd(cmd_buffer, curr_frame_, name);
+  }
+}
+
+// Writes out the last frame rendered in a slot, named after its submission
+// serial. The slot's fence must have signaled.
+void Renderer::WriteReadback(const size_t frame) const {
+  if (!offscreen_.readback() || frame_serials_[frame] == 0) {
+    return;
+  }
+  std::ostringstream name;
+  name << "frame_" << std::setw(6) << std::setfill('0') << frame_serials_[frame] << ".ppm";
+  offscreen_.WriteReadback(frame, readback_dir_ / name.str());
+}
+
+// Records one slice of the draw batches into the calling thread's secondary
+// command buffer for the current frame, continuing the primary's render pass.
+VkCommandBuffer Renderer::RecordSecondaryCommandBuffer(const size_t task, const size_t task_count, const size_t image_idx) const {
+  const RecordWorker& worker = record_workers_[task];
+  if (const VkResult result = vkResetCommandPool(device_.handle(), worker.cmd_pools[curr_frame_].handle(), 0); result != VK_SUCCESS) {
+    throw Error("failed to reset command pool").WithCode(result);
+  }
+  VkCommandBuffer cmd_buffer = worker.cmd_buffers[curr_frame_];
+
+  VkCommandBufferInheritanceInfo inheritance_info = {};
+  inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritance_info.renderPass = render_pass_.handle();
+  inheritance_info.subpass = 0;
+  inheritance_info.framebuffer = swapchain_framebuffers_[image_idx].framebuffer.handle();
+
+  VkCommandBufferBeginInfo cmd_buffer_begin_info = {};
+  cmd_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  cmd_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  cmd_buffer_begin_info.pInheritanceInfo = &inheritance_info;
+  if (const VkResult result = vkBeginCommandBuffer(cmd_buffer, &cmd_buffer_begin_info); result != VK_SUCCESS) {
+    throw Error("failed to begin recording secondary command buffer").WithCode(result);
+  }
+  const size_t batch_count = draw_batches_.size();
+  RecordDraws(cmd_buffer, task * batch_count / task_count, (task + 1) * batch_count / task_count);
+
+  if (const VkResult result = vkEndCommandBuffer(cmd_buffer); result != VK_SUCCESS) {
+    throw Error("failed to record secondary command buffer").WithCode(result);
+  }
+  return cmd_buffer;
+}
+
+// Binds the pipeline state and records the draw batches [first_batch,
+// last_batch). Only reads renderer state, so several threads may record
+// disjoint ranges at once.
+void Renderer::RecordDraws(VkCommandBuffer cmd_buffer, const size_t first_batch, const size_t last_batch) const {
   vkCmdBindPipeline(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_.handle());
 
+  const VkExtent2D extent = GetExtent();
+
   VkViewport viewport = {};
   viewport.x = 0.0f;
-  viewport.y = static_cast<float>(swapchain_.extent().height);
-  viewport.width = static_cast<float>(swapchain_.extent().width);
-  viewport.height = -static_cast<float>(swapchain_.extent().height);
+  viewport.y = static_cast<float>(extent.height);
+  viewport.width = static_cast<float>(extent.width);
+  viewport.height = -static_cast<float>(extent.height);
   viewport.minDepth = 0.0f;
   viewport.maxDepth = 1.0f;
   vkCmdSetViewport(cmd_buffer, 0, 1, &viewport);
 
   VkRect2D scissor = {};
   scissor.offset = {0, 0};
-  scissor.extent = swapchain_.extent();
+  scissor.extent = extent;
   vkCmdSetScissor(cmd_buffer, 0, 1, &scissor);
 
-  VkBuffer vertices_buffer = object_.vertices.handle();
-  VkBuffer indices_buffer = object_.indices.handle();
+  vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_.handle(), 0, 1, &uniform_descriptor_.sets[curr_frame_].handle, 0, nullptr);
+  if (material_layout_.bindless) {
+    vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_.handle(), 1, 1, &material_layout_.descriptor_set, 0, nullptr);
+  }
 
-  VkDeviceSize prev_offset = 0;
+  const FrameDraws& frame_draws = frame_draws_[curr_frame_];
   constexpr std::array vertex_offsets = {VkDeviceSize{0}};
+  constexpr uint32_t draw_command_stride = sizeof(VkDrawIndexedIndirectCommand);
 
-  vkCmdBindVertexBuffers(cmd_buffer, 0, vertex_offsets.size(), &vertices_buffer, vertex_offsets.data());
-  vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_.handle(), 0, 1, &object_.uniform_descriptor.sets[curr_frame_].handle, 0, nullptr);
-
-  for(const auto[index, offset] : object_.usemtl) {
-    vkCmdBindIndexBuffer(cmd_buffer, indices_buffer, prev_offset * sizeof(Index), IndexType<Index>::value);
-    vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_.handle(), 1, 1, &object_.sampler_descriptor.sets[index].handle, 0, nullptr);
-    vkCmdDrawIndexed(cmd_buffer, static_cast<uint32_t>(offset - prev_offset), 1, 0, 0, 0);
+  if (first_batch != last_batch) {
+    VkBuffer transforms_buffer = frame_draws.transforms.handle();
+    vkCmdBindVertexBuffers(cmd_buffer, 2, vertex_offsets.size(), &transforms_buffer, vertex_offsets.data());
+  }
+  engine::MeshId bound_mesh = std::numeric_limits<engine::MeshId>::max();
 
-    prev_offset = offset;
+  for(size_t batch = first_batch; batch < last_batch; ++batch) {
+    if (profiler_.enabled()) {
+      profiler_.RecordGroupBoundary(cmd_buffer, curr_frame_, static_cast<uint32_t>(batch));
+    }
+    const auto[mesh, material, first_command, command_count] = draw_batches_[batch];
+    const Object& object = meshes_[mesh];
+    if (mesh != bound_mesh) {
+      VkBuffer vertices_buffer = object.vertices.handle();
+      vkCmdBindVertexBuffers(cmd_buffer, 0, vertex_offsets.size(), &vertices_buffer, vertex_offsets.data());
+      if (material_layout_.bindless) {
+        VkBuffer materials_buffer = object.materials.handle();
+        vkCmdBindVertexBuffers(cmd_buffer, 1, vertex_offsets.size(), &materials_buffer, vertex_offsets.data());
+      }
+      vkCmdBindIndexBuffer(cmd_buffer, object.indices.handle(), 0, IndexType<Index>::value);
+      bound_mesh = mesh;
+    }
+    if (!material_layout_.bindless) {
+      vkCmdBindDescriptorSets(cmd_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_.handle(), 1, 1, &object.sampler_descriptor.sets[material].handle, 0, nullptr);
+    }
+    if (gpu_culling_) {
+      culler_.RecordDraw(cmd_buffer, curr_frame_, static_cast<uint32_t>(batch), first_command, command_count);
+      continue;
+    }
+    if (multi_draw_indirect_) {
+      vkCmdDrawIndexedIndirect(cmd_buffer, frame_draws.commands.handle(), first_command * draw_command_stride, command_count, draw_command_stride);
+      continue;
+    }
+    for(uint32_t i = first_command; i < first_command + command_count; ++i) {
+      const VkDrawIndexedIndirectCommand& command = draw_commands_[i];
+      vkCmdDrawIndexed(cmd_buffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+    }
   }
-  vkCmdEndRenderPass(cmd_buffer);
-  if (const VkResult result = vkEndCommandBuffer(cmd_buffer); result != VK_SUCCESS) {
-    throw Error("failed to record command buffer").WithCode(result);
+  // Whichever slice holds the last batch also ends its group.
+  if (profiler_.enabled() && first_batch != last_batch && last_batch == draw_batches_.size()) {
+    profiler_.RecordGroupBoundary(cmd_buffer, curr_frame_, static_cast<uint32_t>(last_batch));
   }
 }
 
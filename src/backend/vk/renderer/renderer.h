@@ -1,6 +1,8 @@
 #ifndef BACKEND_VK_RENDERER_RENDERER_H_
 #define BACKEND_VK_RENDERER_RENDERER_H_
 
+#include <atomic>
+#include <filesystem>
 #include <string>
 #include <vector>
 #include <utility>
@@ -11,13 +13,20 @@
 
 #include <vulkan/vulkan.h>
 
+#include "backend/vk/renderer/deletion_queue.h"
 #include "backend/vk/renderer/device.h"
+#include "backend/vk/renderer/gpu_culler.h"
+#include "backend/vk/renderer/gpu_profiler.h"
 #include "backend/vk/renderer/instance.h"
 #include "backend/vk/renderer/object.h"
+#include "backend/vk/renderer/offscreen_target.h"
+#include "backend/vk/renderer/pipeline_cache.h"
+#include "backend/vk/renderer/resource_cache.h"
 #include "backend/vk/renderer/swapchain.h"
 #include "backend/vk/renderer/window.h"
-#include "engine/render/model.h"
+#include "backend/vk/renderer/worker_pool.h"
 #include "engine/render/renderer.h"
+#include "engine/render/scene.h"
 
 namespace vk {
 
@@ -26,6 +35,42 @@ struct SwapchainFramebuffer {
   DeviceHandle<VkImageView> view;
 };
 
+// Host visible buffers rewritten every frame with the scene transforms and
+// the indirect draw commands that reference them through firstInstance.
+struct FrameDraws {
+  Buffer transforms;
+  void* mapped_transforms;
+  Buffer commands;
+  void* mapped_commands;
+  // Scene versions the buffers were last written for.
+  uint64_t transforms_version;
+  uint64_t layout_version;
+};
+
+// Consecutive draw commands of one mesh sharing one material. With GPU
+// culling the commands are the culler's output slots, one per instance.
+struct DrawBatch {
+  engine::MeshId mesh;
+  uint32_t material;
+  uint32_t first_command;
+  uint32_t command_count;
+};
+
+// Command pools and secondary command buffers owned by one recording thread,
+// one of each per frame in flight so a pool is only reset once its frame's
+// fence has signaled.
+struct RecordWorker {
+  std::vector<DeviceHandle<VkCommandPool>> cmd_pools;
+  std::vector<VkCommandBuffer> cmd_buffers;
+};
+
+// Primary command buffer recorded for one frame slot and swapchain image,
+// replayed until the renderer's commands version moves past the recorded one.
+struct CachedCommandBuffer {
+  VkCommandBuffer handle;
+  uint64_t version;
+};
+
 struct SyncObject {
   DeviceHandle<VkSemaphore> image_semaphore;
   DeviceHandle<VkSemaphore> render_semaphore;
@@ -34,24 +79,56 @@ struct SyncObject {
 
 class Renderer final : public engine::Renderer {
 public:
-  explicit Renderer(Window& window, size_t frame_count);
+  Renderer(Window& window, const engine::RendererOptions& options);
   ~Renderer() override;
 
   void RenderFrame() override;
-  void LoadModel(const std::string& path) override;
-  engine::Model& GetModel() noexcept override;
+  engine::MeshId LoadMesh(const std::string& path) override;
+  engine::Scene& GetScene() noexcept override;
+  engine::DrawStats GetDrawStats() const noexcept override;
+  const engine::GpuTimings& GetGpuTimings() const noexcept override;
+  double GetPresentTime() const noexcept override;
+  bool IsSurfaceOutOfDate() const noexcept override;
+  void RecreateSurface() override;
 private:
   void RecreateSwapchain();
+  void OnSwapchainOutOfDate();
   std::pair<Swapchain, Image> CreateSwapchainAndDepthImage() const;
-  std::pair<std::vector<SwapchainFramebuffer>, std::vector<SyncObject>> CreateSwapchainImagesAndSyncObjects() const;
-
-  void UpdateUniforms() const;
+  Image CreateDepthImage(VkExtent2D extent) const;
+  std::vector<SwapchainFramebuffer> CreateSwapchainFramebuffers() const;
+  std::vector<SyncObject> CreateSyncObjects() const;
+  UniformDescriptor CreateUniformDescriptor() const;
+
+  void CreatePipeline();
+  void CreateCachedCommandBuffers();
+  void InvalidateCommandBuffers() noexcept;
+  void UpdateUniforms();
+  void PrepareDraws();
+  void BuildDraws();
+  void AppendCullItems(const Object& object, uint32_t first_command, uint32_t command_count,
+                       const std::vector<engine::InstanceRange>& instances, engine::MeshId mesh, uint32_t material);
+  VkCommandBuffer PrepareCommandBuffer(size_t image_idx);
   void RecordCommandBuffer(VkCommandBuffer cmd_buffer, size_t image_idx);
+  void PrepareProfiler();
+  void RecordPassEnd(VkCommandBuffer cmd_buffer, const char* name);
+  void WriteReadback(size_t frame) const;
+  VkCommandBuffer RecordSecondaryCommandBuffer(size_t task, size_t task_count, size_t image_idx) const;
+  void RecordDraws(VkCommandBuffer cmd_buffer, size_t first_batch, size_t last_batch) const;
+
+  [[nodiscard]] VkExtent2D GetExtent() const noexcept;
 
   Window& window_;
+  bool headless_;
   size_t frame_count_;
-
-  bool framebuffer_resized_;
+  std::vector<VkPresentModeKHR> present_modes_;
+  uint32_t swapchain_image_count_;
+
+  // Set from the window's thread, read by RenderFrame, which may run on a
+  // render thread.
+  std::atomic<bool> framebuffer_resized_;
+  // With a render thread, recreation waits for RecreateSurface.
+  bool defer_recreation_;
+  std::atomic<bool> surface_out_of_date_;
   mutable size_t curr_frame_;
 
   Instance instance_;
@@ -61,26 +138,95 @@ private:
   InstanceHandle<VkSurfaceKHR> surface_;
 
   Device device_;
+  std::filesystem::path pipeline_cache_path_;
+  PipelineCache pipeline_cache_;
+
+  // Submission serial of every frame slot's latest frame, zero before the
+  // first one, used to retire replaced resources.
+  DeletionQueue deletion_queue_;
+  uint64_t frame_serial_;
+  std::vector<uint64_t> frame_serials_;
 
+  // A headless window renders to offscreen images, optionally read back to
+  // readback_dir_, instead of a swapchain.
   Swapchain swapchain_;
+  // Frame fences do not cover presents, so a replaced swapchain is only
+  // retired once an image of its successor has been acquired.
+  std::vector<Swapchain> retired_swapchains_;
+  OffscreenTarget offscreen_;
+  std::filesystem::path readback_dir_;
   Image depth_image_;
   DeviceHandle<VkRenderPass> render_pass_;
   std::vector<SwapchainFramebuffer> swapchain_framebuffers_;
   std::vector<SyncObject> sync_objects_;
+  // Milliseconds the latest frame waited in acquire and present.
+  double present_time_;
 
   DeviceHandle<VkCommandPool> cmd_pool_;
   std::vector<VkCommandBuffer> cmd_buffers_;
 
+  WorkerPool record_pool_;
+  std::vector<RecordWorker> record_workers_;
+
+  bool cached_commands_;
+  DeviceHandle<VkCommandPool> cached_cmd_pool_;
+  std::vector<CachedCommandBuffer> cached_cmd_buffers_;
+  uint64_t commands_version_;
+  uint64_t scene_layout_version_;
+  uint64_t cull_uniforms_version_;
+  bool cull_pyramid_ready_;
+
+  UniformDescriptor uniform_descriptor_;
+  std::vector<Uniforms*> uniforms_buff_;
+  bool multi_draw_indirect_;
+  std::vector<uint64_t> uniforms_versions_;
+
+  TextureCache texture_cache_;
+  SamplerCache sampler_cache_;
+  MaterialLayout material_layout_;
+
   DeviceHandle<VkPipelineLayout> pipeline_layout_;
   DeviceHandle<VkPipeline> pipeline_;
 
-  Object object_;
-  std::vector<Uniforms*> uniforms_buff_;
-  engine::Model model_;
+  std::vector<FrameDraws> frame_draws_;
+  std::vector<VkDrawIndexedIndirectCommand> draw_commands_;
+  std::vector<DrawBatch> draw_batches_;
+  std::vector<std::vector<engine::InstanceRange>> mesh_instances_;
+  engine::DrawStats draw_stats_;
+
+  bool gpu_culling_;
+  GpuCuller culler_;
+  std::vector<CullItem> cull_items_;
+
+  GpuProfiler profiler_;
+  std::vector<engine::GpuGroupTime> profiled_groups_;
+
+  std::vector<Object> meshes_;
+  engine::Scene scene_;
 };
 
-inline engine::Model& Renderer::GetModel() noexcept {
-  return model_;
+inline engine::Scene& Renderer::GetScene() noexcept {
+  return scene_;
+}
+
+inline VkExtent2D Renderer::GetExtent() const noexcept {
+  return headless_ ? offscreen_.extent() : swapchain_.extent();
+}
+
+inline void Renderer::InvalidateCommandBuffers() noexcept {
+  ++commands_version_;
+}
+
+inline engine::DrawStats Renderer::GetDrawStats() const noexcept {
+  return gpu_culling_ ? culler_.stats() : draw_stats_;
+}
+
+inline const engine::GpuTimings& Renderer::GetGpuTimings() const noexcept {
+  return profiler_.timings();
+}
+
+inline double Renderer::GetPresentTime() const noexcept {
+  return present_time_;
 }
 
 } // namespace vk
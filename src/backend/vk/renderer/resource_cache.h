@@ -0,0 +1,68 @@
+#ifndef BACKEND_VK_RENDERER_RESOURCE_CACHE_H_
+#define BACKEND_VK_RENDERER_RESOURCE_CACHE_H_
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "backend/vk/renderer/handle.h"
+#include "backend/vk/renderer/image.h"
+
+namespace vk {
+
+// Hands out resources shared between materials and models. Only weak
+// references are kept, so a resource is destroyed together with the last
+// material that uses it.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ResourceCache {
+public:
+  template<typename CreateFn>
+  [[nodiscard]] std::shared_ptr<const Value> Get(const Key& key, CreateFn&& create);
+private:
+  std::unordered_map<Key, std::weak_ptr<const Value>, Hash> entries_;
+};
+
+template<typename Key, typename Value, typename Hash>
+template<typename CreateFn>
+std::shared_ptr<const Value> ResourceCache<Key, Value, Hash>::Get(const Key& key, CreateFn&& create) {
+  if (const auto it = entries_.find(key); it != entries_.end()) {
+    if (std::shared_ptr<const Value> value = it->second.lock()) {
+      return value;
+    }
+  }
+  for(auto it = entries_.begin(); it != entries_.end();) {
+    it = it->second.expired() ? entries_.erase(it) : std::next(it);
+  }
+  std::shared_ptr<const Value> value = std::make_shared<const Value>(create());
+  entries_[key] = value;
+
+  return value;
+}
+
+struct SamplerKey {
+  VkSamplerMipmapMode mipmap_mode;
+  uint32_t mip_levels;
+
+  bool operator==(const SamplerKey& other) const noexcept {
+    return other.mipmap_mode == mipmap_mode && other.mip_levels == mip_levels;
+  }
+
+  struct Hash {
+    size_t operator()(const SamplerKey& key) const {
+      return std::hash<uint32_t>()(static_cast<uint32_t>(key.mipmap_mode)) ^
+             (std::hash<uint32_t>()(key.mip_levels) << 1);
+    }
+  };
+};
+
+// Textures keyed by canonical file path.
+using TextureCache = ResourceCache<std::string, Image>;
+using SamplerCache = ResourceCache<SamplerKey, DeviceHandle<VkSampler>, SamplerKey::Hash>;
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_RESOURCE_CACHE_H_
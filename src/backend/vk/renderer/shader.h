@@ -20,8 +20,23 @@ struct ShaderInfo {
   std::vector<uint32_t> spirv;
 };
 
+enum class ShaderVariant {
+  kSimple,
+  // Samples material textures from a descriptor array indexed by a
+  // per-instance material attribute.
+  kBindless
+};
+
+enum class ComputeShader {
+  // Culls draw commands against the frustum and the depth pyramid.
+  kCull,
+  // Reduces one depth pyramid level into the next.
+  kDepthPyramid
+};
+
 struct Shader {
-  static std::vector<ShaderInfo> GetInfos();
+  static std::vector<ShaderInfo> GetInfos(ShaderVariant variant);
+  static ShaderInfo GetComputeInfo(ComputeShader shader);
 
   DeviceHandle<VkShaderModule> module;
   ShaderDescription description;
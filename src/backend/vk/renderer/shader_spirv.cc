@@ -0,0 +1,73 @@
+#include "backend/vk/renderer/shader.h"
+
+#include <iterator>
+
+namespace vk {
+
+namespace {
+
+constexpr uint32_t kSimpleVertSpirv[] = {
+#include "spirv/simple.vert.inc"
+};
+
+constexpr uint32_t kSimpleFragSpirv[] = {
+#include "spirv/simple.frag.inc"
+};
+
+constexpr uint32_t kBindlessVertSpirv[] = {
+#include "spirv/bindless.vert.inc"
+};
+
+constexpr uint32_t kBindlessFragSpirv[] = {
+#include "spirv/bindless.frag.inc"
+};
+
+constexpr uint32_t kCullCompSpirv[] = {
+#include "spirv/cull.comp.inc"
+};
+
+constexpr uint32_t kDepthPyramidCompSpirv[] = {
+#include "spirv/depth_pyramid.comp.inc"
+};
+
+} // namespace
+
+std::vector<ShaderInfo> Shader::GetInfos(const ShaderVariant variant) {
+  if (variant == ShaderVariant::kBindless) {
+    return {
+      {
+        ShaderDescription{VK_SHADER_STAGE_VERTEX_BIT, "main"},
+        {std::begin(kBindlessVertSpirv), std::end(kBindlessVertSpirv)}
+      },
+      {
+        ShaderDescription{VK_SHADER_STAGE_FRAGMENT_BIT, "main"},
+        {std::begin(kBindlessFragSpirv), std::end(kBindlessFragSpirv)}
+      }
+    };
+  }
+  return {
+    {
+      ShaderDescription{VK_SHADER_STAGE_VERTEX_BIT, "main"},
+      {std::begin(kSimpleVertSpirv), std::end(kSimpleVertSpirv)}
+    },
+    {
+      ShaderDescription{VK_SHADER_STAGE_FRAGMENT_BIT, "main"},
+      {std::begin(kSimpleFragSpirv), std::end(kSimpleFragSpirv)}
+    }
+  };
+}
+
+ShaderInfo Shader::GetComputeInfo(const ComputeShader shader) {
+  if (shader == ComputeShader::kDepthPyramid) {
+    return {
+      ShaderDescription{VK_SHADER_STAGE_COMPUTE_BIT, "main"},
+      {std::begin(kDepthPyramidCompSpirv), std::end(kDepthPyramidCompSpirv)}
+    };
+  }
+  return {
+    ShaderDescription{VK_SHADER_STAGE_COMPUTE_BIT, "main"},
+    {std::begin(kCullCompSpirv), std::end(kCullCompSpirv)}
+  };
+}
+
+} // namespace vk
@@ -21,12 +21,18 @@ public:
   virtual void WaitUntilResized() const = 0;
 
   [[nodiscard]] virtual std::vector<const char*> GetExtensions() const = 0;
+  // A headless window has no surface, the renderer draws offscreen instead.
+  [[nodiscard]] virtual bool IsHeadless() const noexcept;
 private:
   friend class Instance;
 
   [[nodiscard]] virtual const SurfaceFactory& GetSurfaceFactory() const noexcept = 0;
 };
 
+inline bool Window::IsHeadless() const noexcept {
+  return false;
+}
+
 } // namespace vk
 
 #endif // BACKEND_VK_RENDERER_WINDOW_H_
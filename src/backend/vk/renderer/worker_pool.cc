@@ -0,0 +1,97 @@
+#include "backend/vk/renderer/worker_pool.h"
+
+#include <algorithm>
+#include <string>
+
+#include "trace/trace.h"
+
+namespace vk {
+
+WorkerPool::WorkerPool(const size_t thread_count)
+  : task_(nullptr), task_count_(0), pending_(0), generation_(0), stop_(false) {
+  const size_t worker_count = std::max<size_t>(thread_count, 1) - 1;
+  threads_.reserve(worker_count);
+  for(size_t i = 0; i < worker_count; ++i) {
+    threads_.emplace_back(&WorkerPool::Work, this, i + 1);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for(std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Run(size_t count, const std::function<void(size_t)>& task) {
+  count = std::min(count, size());
+  if (count == 0) {
+    return;
+  }
+  if (count > 1) {
+    {
+      std::lock_guard lock(mutex_);
+      task_ = &task;
+      task_count_ = count;
+      pending_ = count - 1;
+      error_ = nullptr;
+      ++generation_;
+    }
+    start_cv_.notify_all();
+  }
+  std::exception_ptr error;
+  try {
+    task(0);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  if (count > 1) {
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    if (!error) {
+      error = error_;
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkerPool::Work(const size_t index) {
+  TRACE_THREAD_NAME("record worker " + std::to_string(index));
+  uint64_t generation = 0;
+  while (true) {
+    const std::function<void(size_t)>* task;
+    {
+      std::unique_lock lock(mutex_);
+      start_cv_.wait(lock, [&] { return stop_ || generation_ != generation; });
+      if (stop_) {
+        return;
+      }
+      generation = generation_;
+      if (index >= task_count_) {
+        continue;
+      }
+      task = task_;
+    }
+    std::exception_ptr error;
+    try {
+      (*task)(index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard lock(mutex_);
+    if (error && !error_) {
+      error_ = error;
+    }
+    if (--pending_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+} // namespace vk
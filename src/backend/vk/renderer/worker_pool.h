@@ -0,0 +1,53 @@
+#ifndef BACKEND_VK_RENDERER_WORKER_POOL_H_
+#define BACKEND_VK_RENDERER_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vk {
+
+// Fork-join pool of long lived threads. Task i of a Run always executes on
+// thread i, the calling thread being thread 0, so per-thread resources such
+// as command pools can be indexed by the task.
+class WorkerPool {
+public:
+  explicit WorkerPool(size_t thread_count);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool& other) = delete;
+  WorkerPool& operator=(const WorkerPool& other) = delete;
+
+  [[nodiscard]] size_t size() const noexcept;
+
+  // Runs task(i) for every i < min(count, size()) and returns once all of
+  // them are done, rethrowing the first exception any of them threw.
+  void Run(size_t count, const std::function<void(size_t)>& task);
+private:
+  void Work(size_t index);
+
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+
+  const std::function<void(size_t)>* task_;
+  size_t task_count_;
+  size_t pending_;
+  uint64_t generation_;
+  bool stop_;
+  std::exception_ptr error_;
+};
+
+inline size_t WorkerPool::size() const noexcept {
+  return threads_.size() + 1;
+}
+
+} // namespace vk
+
+#endif // BACKEND_VK_RENDERER_WORKER_POOL_H_
@@ -0,0 +1,102 @@
+#ifndef BACKEND_VK_WINDOW_HEADLESS_WINDOW_H_
+#define BACKEND_VK_WINDOW_HEADLESS_WINDOW_H_
+
+#include <string>
+#include <vector>
+
+#include "backend/vk/renderer/window.h"
+
+namespace headless::vk {
+
+// Never asked for a surface, the renderer checks IsHeadless first.
+class SurfaceFactory final : public ::vk::SurfaceFactory {
+public:
+  ~SurfaceFactory() noexcept override = default;
+
+  [[nodiscard]] VkSurfaceKHR CreateSurface(VkInstance instance, const VkAllocationCallbacks *allocator) const noexcept override;
+};
+
+// Window without a display connection or surface, for benchmarking and
+// validating frames on machines without one. It never closes by itself, the
+// runner's frame limit ends the loop.
+class Window final : public ::vk::Window {
+public:
+  Window(int width, int height) noexcept;
+  ~Window() noexcept override = default;
+
+  [[nodiscard]] bool ShouldClose() const noexcept override;
+  [[nodiscard]] bool IsClosable() const noexcept override;
+  void Loop() const override;
+
+  void SetWindowTitle(const std::string& title) noexcept override;
+  void SetWindowEventHandler(EventHandler* handler) noexcept override;
+  void SetWindowResizedCallback(ResizeCallback resize_callback) noexcept override;
+
+  [[nodiscard]] int GetWidth() const noexcept override;
+  [[nodiscard]] int GetHeight() const noexcept override;
+
+  void WaitUntilResized() const noexcept override;
+
+  [[nodiscard]] std::vector<const char*> GetExtensions() const override;
+  [[nodiscard]] bool IsHeadless() const noexcept override;
+  [[nodiscard]] const ::vk::SurfaceFactory& GetSurfaceFactory() const noexcept override;
+private:
+  int width_;
+  int height_;
+  EventHandler* event_handler_;
+  SurfaceFactory surface_factory_;
+};
+
+inline VkSurfaceKHR SurfaceFactory::CreateSurface([[maybe_unused]] VkInstance instance, [[maybe_unused]] const VkAllocationCallbacks *allocator) const noexcept {
+  return VK_NULL_HANDLE;
+}
+
+inline Window::Window(const int width, const int height) noexcept
+  : width_(width), height_(height), event_handler_(nullptr) {}
+
+inline bool Window::ShouldClose() const noexcept {
+  return false;
+}
+
+inline bool Window::IsClosable() const noexcept {
+  return false;
+}
+
+inline void Window::Loop() const {
+  event_handler_->OnRenderEvent();
+}
+
+inline void Window::SetWindowTitle([[maybe_unused]] const std::string& title) noexcept {}
+
+inline void Window::SetWindowEventHandler(EventHandler* handler) noexcept {
+  event_handler_ = handler;
+}
+
+// The size never changes, so the callback is never invoked.
+inline void Window::SetWindowResizedCallback([[maybe_unused]] ResizeCallback resize_callback) noexcept {}
+
+inline int Window::GetWidth() const noexcept {
+  return width_;
+}
+
+inline int Window::GetHeight() const noexcept {
+  return height_;
+}
+
+inline void Window::WaitUntilResized() const noexcept {}
+
+inline std::vector<const char*> Window::GetExtensions() const {
+  return {};
+}
+
+inline bool Window::IsHeadless() const noexcept {
+  return true;
+}
+
+inline const ::vk::SurfaceFactory& Window::GetSurfaceFactory() const noexcept {
+  return surface_factory_;
+}
+
+} // namespace headless::vk
+
+#endif // BACKEND_VK_WINDOW_HEADLESS_WINDOW_H_
@@ -0,0 +1,293 @@
+#include "engine/bench_runner.h"
+#include "engine/camera_script.h"
+#include "engine/config.h"
+#include "engine/error.h"
+#include "engine/scenario.h"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr const char* kUsage =
+  "usage: engine_bench [--renderers vk,gl,null] [--windows sdl,glfw,headless,null] [--models a.obj,b.obj]\n"
+  "                    [--scenarios a.scn,b.scn] [--frames N] [--warmup N] [--camera script]\n"
+  "                    [--output results.json]";
+constexpr const char* kDefaultModel = "../obj/Madara Uchiha/obj/Madara_Uchiha.obj";
+constexpr std::array<const char*, engine::FrameStats::kMetricCount> kMetricNames = {"frame", "render", "present"};
+
+struct BenchArgs {
+  std::vector<std::string> renderers;
+  std::vector<std::string> windows;
+  std::vector<std::string> models;
+  std::vector<std::string> scenarios;
+  uint64_t measured_frames;
+  uint64_t warmup_frames;
+  // Applies to the model workloads, scenarios bring their own camera.
+  std::string camera_path;
+  std::string output_path;
+};
+
+// A model spinning under the camera script, or a scenario file.
+struct Workload {
+  const char* kind;
+  std::string path;
+  engine::Scenario scenario;
+};
+
+// Kilobytes, zero where /proc is not available.
+struct MemoryUsage {
+  uint64_t rss;
+  uint64_t peak_rss;
+};
+
+struct BenchRecord {
+  std::string renderer;
+  std::string window;
+  const char* kind;
+  std::string path;
+  // Empty when the combination ran.
+  std::string error;
+  // Milliseconds from loading the plugins to a created renderer.
+  double startup_time;
+  engine::BenchResult result;
+  MemoryUsage memory;
+};
+
+std::vector<std::string> SplitList(const std::string& list) {
+  std::vector<std::string> items;
+  std::istringstream stream(list);
+  for(std::string item; std::getline(stream, item, ',');) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+uint64_t ParseCount(const std::string& name, const std::string& value) {
+  char* end;
+  const unsigned long long count = std::strtoull(value.c_str(), &end, 10);
+  if (end == value.c_str() || *end != '\0') {
+    throw Error("invalid " + name + ": " + value);
+  }
+  return count;
+}
+
+BenchArgs ParseArgs(const int argc, char** argv) {
+  BenchArgs args = {};
+#ifdef ENGINE_STATIC_PLUGINS
+  args.renderers = {ENGINE_STATIC_RENDERER_NAME};
+  args.windows = {ENGINE_STATIC_WINDOW_NAME};
+#else
+  args.renderers = {std::string(engine::RendererType::kVk), std::string(engine::RendererType::kGl)};
+  args.windows = {std::string(engine::WindowType::kHeadless)};
+#endif
+  args.measured_frames = 1000;
+  args.warmup_frames = 100;
+  for(int i = 1; i < argc; ++i) {
+    const std::string name = argv[i];
+    if (i + 1 == argc) {
+      throw Error("missing value of " + name);
+    }
+    const std::string value = argv[++i];
+    if (name == "--renderers") {
+      args.renderers = SplitList(value);
+    } else if (name == "--windows") {
+      args.windows = SplitList(value);
+    } else if (name == "--models") {
+      args.models = SplitList(value);
+    } else if (name == "--scenarios") {
+      args.scenarios = SplitList(value);
+    } else if (name == "--frames") {
+      args.measured_frames = ParseCount(name, value);
+    } else if (name == "--warmup") {
+      args.warmup_frames = ParseCount(name, value);
+    } else if (name == "--camera") {
+      args.camera_path = value;
+    } else if (name == "--output") {
+      args.output_path = value;
+    } else {
+      throw Error("unknown option " + name);
+    }
+  }
+  if (args.models.empty() && args.scenarios.empty()) {
+    args.models = {kDefaultModel};
+  }
+  return args;
+}
+
+MemoryUsage GetMemoryUsage() {
+  MemoryUsage usage = {};
+  std::ifstream status("/proc/self/status");
+  for(std::string line; std::getline(status, line);) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      usage.rss = std::strtoull(line.c_str() + 6, nullptr, 10);
+    } else if (line.compare(0, 6, "VmHWM:") == 0) {
+      usage.peak_rss = std::strtoull(line.c_str() + 6, nullptr, 10);
+    }
+  }
+  return usage;
+}
+
+// Makes the peak reported for a combination its own rather than the
+// highest of every combination run so far in this process.
+void ResetPeakMemoryUsage() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+std::vector<Workload> GetWorkloads(const BenchArgs& args) {
+  const engine::CameraScript camera_script = args.camera_path.empty() ? engine::CameraScript() : engine::CameraScript::FromFile(args.camera_path);
+  std::vector<Workload> workloads;
+  for(const std::string& model : args.models) {
+    engine::Scenario scenario = engine::Scenario::FromModel(model);
+    scenario.SetCameraScript(camera_script);
+    workloads.push_back({"model", model, std::move(scenario)});
+  }
+  for(const std::string& path : args.scenarios) {
+    workloads.push_back({"scenario", path, engine::Scenario::FromFile(path)});
+  }
+  return workloads;
+}
+
+BenchRecord RunCombination(const BenchArgs& args, const std::string& renderer, const std::string& window, const Workload& workload) {
+  BenchRecord record = {};
+  record.renderer = renderer;
+  record.window = window;
+  record.kind = workload.kind;
+  record.path = workload.path;
+  ResetPeakMemoryUsage();
+  try {
+    engine::Config config(renderer, window);
+    // Uncapped unless a present mode is asked for, as with ENGINE_BENCHMARK.
+    if (std::getenv("ENGINE_PRESENT_MODE") == nullptr) {
+      config.renderer_options.present_mode = engine::PresentMode::kLowestLatency;
+    }
+    // Render times are measured around RenderFrame on the calling thread.
+    config.renderer_options.render_thread = false;
+    engine::BenchOptions options = {};
+    options.scenario = &workload.scenario;
+    options.warmup_frames = args.warmup_frames;
+    options.measured_frames = args.measured_frames;
+
+    const auto startup_begin = std::chrono::steady_clock::now();
+    const engine::WindowLoader window_loader(config.window_plugin_path);
+    const engine::RendererLoader renderer_loader(config.renderer_plugin_path);
+    engine::BenchRunner runner(renderer_loader, window_loader, config, options);
+    record.startup_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startup_begin).count();
+
+    record.result = runner.Run();
+    record.memory = GetMemoryUsage();
+  } catch (const std::exception& error) {
+    record.error = error.what();
+  }
+  return record;
+}
+
+void WriteString(std::ostream& stream, const std::string& string) {
+  stream << '"';
+  for(const char c : string) {
+    if (c == '"' || c == '\\') {
+      stream << '\\';
+    }
+    stream << c;
+  }
+  stream << '"';
+}
+
+void WriteRecord(std::ostream& stream, const BenchRecord& record) {
+  stream << "    {\"renderer\": ";
+  WriteString(stream, record.renderer);
+  stream << ", \"window\": ";
+  WriteString(stream, record.window);
+  stream << ", \"" << record.kind << "\": ";
+  WriteString(stream, record.path);
+  if (!record.error.empty()) {
+    stream << ", \"error\": ";
+    WriteString(stream, record.error);
+    stream << '}';
+    return;
+  }
+  const engine::BenchResult& result = record.result;
+  stream << ",\n     \"startup_ms\": " << record.startup_time
+         << ", \"load_ms\": " << result.load_time
+         << ", \"frames\": " << result.frames
+         << ", \"fps\": " << (result.elapsed > 0.0 ? static_cast<double>(result.frames) / result.elapsed : 0.0)
+         << ", \"gpu_frame_ms\": " << result.gpu_frame_time
+         << ", \"drawn\": " << result.draw_stats.drawn
+         << ", \"culled\": " << result.draw_stats.culled
+         << ", \"rss_kb\": " << record.memory.rss
+         << ", \"peak_rss_kb\": " << record.memory.peak_rss;
+  for(size_t metric = 0; metric < kMetricNames.size(); ++metric) {
+    const engine::FrameStatsSummary& summary = result.metrics[metric];
+    stream << ",\n     \"" << kMetricNames[metric] << "_ms\": {"
+           << "\"min\": " << summary.min
+           << ", \"avg\": " << summary.avg
+           << ", \"p50\": " << summary.p50
+           << ", \"p95\": " << summary.p95
+           << ", \"p99\": " << summary.p99
+           << ", \"max\": " << summary.max << '}';
+  }
+  stream << '}';
+}
+
+void WriteResults(std::ostream& stream, const BenchArgs& args, const std::vector<BenchRecord>& records) {
+  stream << "{\n  \"warmup_frames\": " << args.warmup_frames
+         << ",\n  \"measured_frames\": " << args.measured_frames
+         << ",\n  \"camera\": ";
+  WriteString(stream, args.camera_path);
+  stream << ",\n  \"runs\": [";
+  for(size_t i = 0; i < records.size(); ++i) {
+    stream << (i == 0 ? "\n" : ",\n");
+    WriteRecord(stream, records[i]);
+  }
+  stream << "\n  ]\n}\n";
+}
+
+} // namespace
+
+// Runs every renderer x window x workload combination in turn and writes one
+// JSON document of results, to --output or stdout. A combination that
+// fails is recorded with its error and the rest still run; the exit status
+// tells whether all of them succeeded.
+int main(const int argc, char** argv) {
+  try {
+    const BenchArgs args = ParseArgs(argc, argv);
+    const std::vector<Workload> workloads = GetWorkloads(args);
+
+    std::vector<BenchRecord> records;
+    bool failed = false;
+    for(const std::string& renderer : args.renderers) {
+      for(const std::string& window : args.windows) {
+        for(const Workload& workload : workloads) {
+          std::cerr << "bench: " << renderer << ' ' << window << ' ' << workload.path << std::endl;
+          records.push_back(RunCombination(args, renderer, window, workload));
+          if (!records.back().error.empty()) {
+            std::cerr << "bench: " << records.back().error << std::endl;
+            failed = true;
+          }
+        }
+      }
+    }
+    if (args.output_path.empty()) {
+      WriteResults(std::cout, args, records);
+    } else {
+      std::ofstream file(args.output_path);
+      if (!file) {
+        throw Error("failed to open " + args.output_path);
+      }
+      WriteResults(file, args, records);
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << '\n' << kUsage << std::endl;
+  }
+  return EXIT_FAILURE;
+}
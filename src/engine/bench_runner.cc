@@ -0,0 +1,88 @@
+#include "engine/bench_runner.h"
+
+#include "engine/cast_util.h"
+#include "trace/trace.h"
+
+namespace engine {
+
+namespace {
+
+double Milliseconds(const std::chrono::steady_clock::duration duration) noexcept {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+BenchRunner::BenchRunner(const RendererLoader& renderer_loader, const WindowLoader& window_loader, const Config& config, const BenchOptions& options)
+    : options_(options),
+      frame_count_(0),
+      frame_stats_(options.measured_frames),
+      render_time_(0.0),
+      present_time_(0.0),
+      gpu_time_(0.0),
+      gpu_frames_(0),
+      instance_(window_loader.LoadInstance()),
+      window_handle_(window_loader.LoadWindow(1280, 720, config.title)),
+      renderer_handle_(renderer_loader.Load(*window_handle_, config.renderer_options)),
+      window_(NAMED_DYNAMIC_CAST(LinkedWindow&, *window_handle_)),
+      renderer_(NAMED_DYNAMIC_CAST(LinkedRenderer&, *renderer_handle_)) {}
+
+BenchResult BenchRunner::Run() {
+  BenchResult result = {};
+  const Clock::time_point load_begin = Clock::now();
+  objects_ = options_.scenario->Load(renderer_);
+  result.load_time = Milliseconds(Clock::now() - load_begin);
+
+  renderer_.GetScene().SetViewport(window_.GetWidth(), window_.GetHeight());
+  window_.SetWindowEventHandler(this);
+
+  const uint64_t frame_limit = options_.warmup_frames + options_.measured_frames;
+  Clock::time_point frame_begin = Clock::now();
+  Clock::time_point measure_begin = frame_begin;
+  while (!window_.ShouldClose() && frame_count_ < frame_limit) {
+    TRACE_ZONE("frame");
+    const uint64_t frame = frame_count_;
+    if (frame <= options_.warmup_frames) {
+      measure_begin = frame_begin;
+    }
+    event_end_ = frame_begin;
+    render_time_ = 0.0;
+    present_time_ = 0.0;
+    window_.Loop();
+    const Clock::time_point frame_end = Clock::now();
+    if (frame_count_ != frame && frame >= options_.warmup_frames) {
+      frame_stats_.Add(Milliseconds(frame_end - frame_begin), render_time_, present_time_ + Milliseconds(frame_end - event_end_));
+    }
+    frame_begin = frame_end;
+  }
+  result.frames = frame_stats_.total();
+  if (result.frames != 0) {
+    result.elapsed = std::chrono::duration<double>(frame_begin - measure_begin).count();
+  }
+  for(size_t metric = 0; metric < FrameStats::kMetricCount; ++metric) {
+    result.metrics[metric] = frame_stats_.Summarize(static_cast<FrameMetric>(metric));
+  }
+  if (gpu_frames_ != 0) {
+    result.gpu_frame_time = gpu_time_ / static_cast<double>(gpu_frames_);
+  }
+  result.draw_stats = renderer_.GetDrawStats();
+  return result;
+}
+
+void BenchRunner::OnRenderEvent() {
+  options_.scenario->Apply(renderer_.GetScene(), objects_, frame_count_);
+  const Clock::time_point render_begin = Clock::now();
+  renderer_.RenderFrame();
+  event_end_ = Clock::now();
+  present_time_ = renderer_.GetPresentTime();
+  render_time_ = Milliseconds(event_end_ - render_begin) - present_time_;
+  if (frame_count_ >= options_.warmup_frames) {
+    if (const double gpu_time = renderer_.GetGpuTimings().frame; gpu_time > 0.0) {
+      gpu_time_ += gpu_time;
+      ++gpu_frames_;
+    }
+  }
+  ++frame_count_;
+}
+
+} // namespace engine
@@ -0,0 +1,70 @@
+#ifndef ENGINE_BENCH_RUNNER_H_
+#define ENGINE_BENCH_RUNNER_H_
+
+#include <array>
+#include <chrono>
+#include <string>
+
+#include "engine/config.h"
+#include "engine/frame_stats.h"
+#include "engine/linked_plugins.h"
+#include "engine/scenario.h"
+#include "engine/window/window_loader.h"
+#include "engine/render/renderer_loader.h"
+
+namespace engine {
+
+struct BenchOptions {
+  const Scenario* scenario;
+  uint64_t warmup_frames;
+  uint64_t measured_frames;
+};
+
+struct BenchResult {
+  // Milliseconds spent loading the scenario's models.
+  double load_time;
+  // Frames rendered after the warmup and the seconds they took.
+  uint64_t frames;
+  double elapsed;
+  std::array<FrameStatsSummary, FrameStats::kMetricCount> metrics;
+  // Average over the measured frames, zero when the backend cannot tell.
+  double gpu_frame_time;
+  DrawStats draw_stats;
+};
+
+// Loads a scenario and renders a fixed number of frames, leaving the first
+// warmup_frames out of the statistics so pipeline creation, uploads and
+// driver warmup do not skew the steady state.
+class BenchRunner final : public Window::EventHandler {
+public:
+  BenchRunner(const RendererLoader& renderer_loader, const WindowLoader& window_loader, const Config& config, const BenchOptions& options);
+  ~BenchRunner() override = default;
+
+  [[nodiscard]] BenchResult Run();
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void OnRenderEvent() override;
+
+  BenchOptions options_;
+  uint64_t frame_count_;
+
+  FrameStats frame_stats_;
+  // RenderFrame's share of the frame and the part of it spent presenting.
+  double render_time_;
+  double present_time_;
+  Clock::time_point event_end_;
+  double gpu_time_;
+  uint64_t gpu_frames_;
+
+  std::vector<ObjectId> objects_;
+  Instance::Handle instance_;
+  Window::Handle window_handle_;
+  Renderer::Handle renderer_handle_;
+  LinkedWindow& window_;
+  LinkedRenderer& renderer_;
+};
+
+} // namespace engine
+
+#endif // ENGINE_BENCH_RUNNER_H_
@@ -0,0 +1,83 @@
+#include "engine/camera_script.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "engine/error.h"
+
+namespace engine {
+
+CameraScript CameraScript::FromFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw Error("failed to open camera script " + path);
+  }
+  std::vector<CameraKeyframe> keyframes;
+  std::string line;
+  for(size_t line_number = 1; std::getline(file, line); ++line_number) {
+    std::istringstream stream(line);
+    std::string first;
+    if (!(stream >> first) || first[0] == '#') {
+      continue;
+    }
+    stream.str(line);
+    stream.clear();
+    CameraKeyframe keyframe = {};
+    if (!ParseKeyframe(stream, keyframe)) {
+      throw Error(path + ":" + std::to_string(line_number) + ": invalid camera keyframe");
+    }
+    keyframes.push_back(keyframe);
+  }
+  return CameraScript(std::move(keyframes));
+}
+
+bool CameraScript::ParseKeyframe(std::istream& stream, CameraKeyframe& keyframe) {
+  return static_cast<bool>(stream >> keyframe.frame
+                                  >> keyframe.eye.x >> keyframe.eye.y >> keyframe.eye.z
+                                  >> keyframe.target.x >> keyframe.target.y >> keyframe.target.z);
+}
+
+CameraScript::CameraScript(std::vector<CameraKeyframe> keyframes) : keyframes_(std::move(keyframes)) {
+  for(size_t i = 1; i < keyframes_.size(); ++i) {
+    if (keyframes_[i].frame <= keyframes_[i - 1].frame) {
+      throw Error("camera keyframes are not in increasing frame order");
+    }
+  }
+}
+
+void CameraScript::Apply(Scene& scene, const uint64_t frame) const noexcept {
+  if (keyframes_.empty()) {
+    return;
+  }
+  const CameraKeyframe& first = keyframes_.front();
+  // The hold before the first keyframe is set on frame 0 and lasts through
+  // the first keyframe, the one after the last is set by the last keyframe.
+  if (frame <= first.frame) {
+    if (frame == 0) {
+      scene.SetCamera(first.eye, first.target);
+    }
+    return;
+  }
+  if (frame > keyframes_.back().frame) {
+    return;
+  }
+  const CameraKeyframe pose = Interpolate(frame);
+  const CameraKeyframe prev_pose = Interpolate(frame - 1);
+  if (pose.eye != prev_pose.eye || pose.target != prev_pose.target) {
+    scene.SetCamera(pose.eye, pose.target);
+  }
+}
+
+CameraKeyframe CameraScript::Interpolate(const uint64_t frame) const noexcept {
+  const auto next = std::upper_bound(keyframes_.begin(), keyframes_.end(), frame,
+                                     [](const uint64_t f, const CameraKeyframe& keyframe) { return f < keyframe.frame; });
+  const CameraKeyframe& prev = *(next - 1);
+  if (next == keyframes_.end()) {
+    return prev;
+  }
+  const auto t = static_cast<float>(frame - prev.frame) / static_cast<float>(next->frame - prev.frame);
+  return {frame, glm::mix(prev.eye, next->eye, t), glm::mix(prev.target, next->target, t)};
+}
+
+} // namespace engine
@@ -0,0 +1,56 @@
+#ifndef ENGINE_CAMERA_SCRIPT_H_
+#define ENGINE_CAMERA_SCRIPT_H_
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "engine/render/scene.h"
+
+namespace engine {
+
+struct CameraKeyframe {
+  uint64_t frame;
+  glm::vec3 eye;
+  glm::vec3 target;
+};
+
+// Camera path keyed by frame index rather than time, so a run renders the
+// same frames whatever its frame rate. Eye and target are interpolated
+// linearly between keyframes and held before the first and after the last.
+class CameraScript {
+public:
+  // One keyframe per line, "frame eye_x eye_y eye_z target_x target_y
+  // target_z", with frames strictly increasing. Blank lines and lines
+  // starting with # are skipped.
+  [[nodiscard]] static CameraScript FromFile(const std::string& path);
+  // Reads the fields of one keyframe, returning false when they are not all
+  // there.
+  static bool ParseKeyframe(std::istream& stream, CameraKeyframe& keyframe);
+
+  CameraScript() = default;
+  explicit CameraScript(std::vector<CameraKeyframe> keyframes);
+
+  // Expects consecutive frames from 0 on the same scene. The camera is only
+  // set when it moved since the previous frame, so held and repeated poses
+  // leave the uniforms version alone.
+  void Apply(Scene& scene, uint64_t frame) const noexcept;
+
+  [[nodiscard]] bool empty() const noexcept;
+private:
+  // Pose at a frame within the keyframes' span.
+  [[nodiscard]] CameraKeyframe Interpolate(uint64_t frame) const noexcept;
+
+  std::vector<CameraKeyframe> keyframes_;
+};
+
+inline bool CameraScript::empty() const noexcept {
+  return keyframes_.empty();
+}
+
+} // namespace engine
+
+#endif // ENGINE_CAMERA_SCRIPT_H_
@@ -1,7 +1,12 @@
 #include "engine/config.h"
 
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <sstream>
 
+#include "engine/error.h"
+
 #ifdef _WIN32
 #define DL_PREFIX_PATH
 #else
@@ -12,6 +17,8 @@ namespace engine {
 
 namespace {
 
+constexpr uint32_t kDefaultFramesInFlight = 2;
+
 std::string GetRendererDllPath(const RendererType::Name renderer_name) {
   std::stringstream ss;
   ss << DL_PREFIX_PATH"lib" << renderer_name << "_renderer";
@@ -31,11 +38,87 @@ std::string GetTitle(const RendererType::Name renderer_name, const WindowType::N
   return ss.str();
 }
 
+bool BenchmarkIsEnabled() noexcept {
+  const char* env = std::getenv("ENGINE_BENCHMARK");
+  return env != nullptr && std::strcmp(env, "0") != 0;
+}
+
+bool RenderThreadIsEnabled() noexcept {
+  const char* env = std::getenv("ENGINE_RENDER_THREAD");
+  return env != nullptr && std::strcmp(env, "0") != 0;
+}
+
+bool GetFlag(const char* name, const bool default_value) noexcept {
+  const char* env = std::getenv(name);
+  return env == nullptr ? default_value : std::strcmp(env, "0") != 0;
+}
+
+PresentMode GetPresentMode(const bool benchmark) {
+  const char* env = std::getenv("ENGINE_PRESENT_MODE");
+  if (env == nullptr) {
+    return benchmark ? PresentMode::kLowestLatency : PresentMode::kFifo;
+  }
+  const std::string_view name = env;
+  if (name == "fifo") {
+    return PresentMode::kFifo;
+  }
+  if (name == "fifo_relaxed") {
+    return PresentMode::kFifoRelaxed;
+  }
+  if (name == "mailbox") {
+    return PresentMode::kMailbox;
+  }
+  if (name == "immediate") {
+    return PresentMode::kImmediate;
+  }
+  if (name == "lowest_latency") {
+    return PresentMode::kLowestLatency;
+  }
+  throw Error("unknown present mode: " + std::string(name));
+}
+
+uint32_t GetCount(const char* name, const uint32_t default_count, const uint32_t min_count) {
+  const char* env = std::getenv(name);
+  if (env == nullptr) {
+    return default_count;
+  }
+  char* end;
+  const unsigned long count = std::strtoul(env, &end, 10);
+  if (end == env || *end != '\0' || count < min_count || count > std::numeric_limits<uint32_t>::max()) {
+    throw Error(std::string("invalid ") + name + ": " + env);
+  }
+  return static_cast<uint32_t>(count);
+}
+
+std::string GetFrameStatsPath() {
+  const char* env = std::getenv("ENGINE_FRAME_STATS");
+  return env != nullptr ? env : std::string();
+}
+
+std::string GetScenarioPath() {
+  const char* env = std::getenv("ENGINE_SCENARIO");
+  return env != nullptr ? env : std::string();
+}
+
 } // namespace
 
 Config::Config(RendererType::Name renderer_type, WindowType::Name window_type)
   : window_plugin_path(GetWindowDllPath(renderer_type, window_type)),
     renderer_plugin_path(GetRendererDllPath(renderer_type)),
-    title(GetTitle(renderer_type, window_type)) {}
+    title(GetTitle(renderer_type, window_type)),
+    renderer_options(),
+    benchmark(BenchmarkIsEnabled()),
+    frame_limit(GetCount("ENGINE_FRAME_LIMIT", 0, 0)),
+    frame_stats_path(GetFrameStatsPath()),
+    scenario_path(GetScenarioPath()) {
+  renderer_options.present_mode = GetPresentMode(benchmark);
+  renderer_options.frames_in_flight = GetCount("ENGINE_FRAMES_IN_FLIGHT", kDefaultFramesInFlight, 1);
+  renderer_options.swapchain_images = GetCount("ENGINE_SWAPCHAIN_IMAGES", 0, 0);
+  renderer_options.render_thread = RenderThreadIsEnabled();
+  renderer_options.bindless = GetFlag("ENGINE_BINDLESS", false);
+  renderer_options.pipeline_cache = GetFlag("ENGINE_PIPELINE_CACHE", true);
+  renderer_options.gpu_culling = GetFlag("ENGINE_GPU_CULLING", false);
+  renderer_options.gpu_profiler = GetFlag("ENGINE_GPU_PROFILER", true);
+}
 
 } // namespace engine
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "engine/render/types.h"
+
 namespace engine {
 
 struct RendererType {
@@ -10,6 +12,9 @@ struct RendererType {
 
   static constexpr Name kVk = "vk";
   static constexpr Name kGl = "gl";
+  // Runs the load pipeline and the CPU side of each frame without a
+  // graphics API, paired with the null window.
+  static constexpr Name kNull = "null";
 };
 
 struct WindowType {
@@ -17,8 +22,28 @@ struct WindowType {
 
   static constexpr Name kGlfw = "glfw";
   static constexpr Name kSdl = "sdl";
+  // No display: Vulkan renders offscreen, GL to an EGL pbuffer.
+  static constexpr Name kHeadless = "headless";
+  static constexpr Name kNull = "null";
 };
 
+// ENGINE_PRESENT_MODE selects one of fifo, fifo_relaxed, mailbox, immediate
+// or lowest_latency. ENGINE_FRAMES_IN_FLIGHT (default 2) and
+// ENGINE_SWAPCHAIN_IMAGES (default chosen by the backend) set the depth of
+// the frame queue. ENGINE_BENCHMARK renders uncapped, defaulting the
+// present mode to lowest_latency, and reports throughput on exit.
+// ENGINE_FRAME_LIMIT stops after that many frames, which is how a headless
+// or null window ever finishes, those defaulting to 1000 frames. ENGINE_FRAME_STATS names a file the frame time
+// statistics are written to on exit, as JSON for a .json path and CSV
+// otherwise. ENGINE_SCENARIO names a scenario file to run instead of the
+// default spinning model, its frame count applying unless a limit is set.
+// ENGINE_RENDER_THREAD renders on a thread of its own, fed snapshots of the
+// scene, while the main thread handles window events. GL does not support it.
+// ENGINE_GPU_PROFILER=0 turns off the GPU timestamp queries. Vulkan only:
+// ENGINE_BINDLESS draws every material from one texture array,
+// ENGINE_GPU_CULLING culls frustum and occlusion (against the previous
+// frame's depth) in a compute pass, and ENGINE_PIPELINE_CACHE=0 turns off
+// the pipeline cache kept between runs.
 struct Config {
   Config(RendererType::Name renderer_type, WindowType::Name window_type);
 
@@ -26,6 +51,12 @@ struct Config {
   std::string renderer_plugin_path;
 
   std::string title;
+
+  RendererOptions renderer_options;
+  bool benchmark;
+  uint64_t frame_limit;
+  std::string frame_stats_path;
+  std::string scenario_path;
 };
 
 
@@ -74,6 +74,16 @@ inline DllLoader::~DllLoader() {
   }
 }
 
+#ifdef ENGINE_STATIC_PLUGINS
+// With a backend linked in there is nothing to open, the path only has to
+// name the library that was linked.
+inline void CheckLinkedLibrary(const std::string& path, const std::string& name) {
+  if (std::filesystem::path(path).filename() != "lib" + name) {
+    throw Error("Library is not linked in: " + path + ", only lib" + name + " is");
+  }
+}
+#endif
+
 template <typename T>
 inline T DllLoader::Load(const std::string& sym_name) const {
   auto proc = DL_SYM(handle_, sym_name.c_str());
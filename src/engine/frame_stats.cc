@@ -0,0 +1,109 @@
+#include "engine/frame_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine {
+
+namespace {
+
+constexpr std::array<const char*, FrameStats::kMetricCount> kMetricNames = {"frame", "render", "present"};
+
+// Nearest-rank percentile of sorted samples.
+double Percentile(const std::vector<double>& sorted, const double percentile) noexcept {
+  const auto rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // namespace
+
+FrameStats::FrameStats(const size_t capacity)
+  : capacity_(std::max<size_t>(capacity, 1)), next_(0), total_(0) {
+  for(std::vector<double>& samples : samples_) {
+    samples.resize(capacity_);
+  }
+}
+
+void FrameStats::Add(const double frame_time, const double render_time, const double present_time) noexcept {
+  samples_[static_cast<size_t>(FrameMetric::kFrame)][next_] = frame_time;
+  samples_[static_cast<size_t>(FrameMetric::kRender)][next_] = render_time;
+  samples_[static_cast<size_t>(FrameMetric::kPresent)][next_] = present_time;
+  next_ = (next_ + 1) % capacity_;
+  ++total_;
+}
+
+FrameStatsSummary FrameStats::Summarize(const FrameMetric metric) const {
+  const size_t count = size();
+  if (count == 0) {
+    return {};
+  }
+  const std::vector<double>& samples = samples_[static_cast<size_t>(metric)];
+  sorted_.assign(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(count));
+  std::sort(sorted_.begin(), sorted_.end());
+
+  double sum = 0.0;
+  for(const double sample : sorted_) {
+    sum += sample;
+  }
+  FrameStatsSummary summary = {};
+  summary.min = sorted_.front();
+  summary.avg = sum / static_cast<double>(count);
+  summary.p50 = Percentile(sorted_, 0.50);
+  summary.p95 = Percentile(sorted_, 0.95);
+  summary.p99 = Percentile(sorted_, 0.99);
+  summary.max = sorted_.back();
+  return summary;
+}
+
+FrameStats::Histogram FrameStats::GetHistogram(const FrameMetric metric) const noexcept {
+  Histogram histogram = {};
+  const std::vector<double>& samples = samples_[static_cast<size_t>(metric)];
+  for(size_t i = 0; i < size(); ++i) {
+    const auto bucket = static_cast<size_t>(std::max(samples[i], 0.0) / kHistogramBucketWidth);
+    ++histogram[std::min(bucket, kHistogramBuckets - 1)];
+  }
+  return histogram;
+}
+
+void FrameStats::WriteCsv(std::ostream& stream) const {
+  stream << "frame";
+  for(const char* name : kMetricNames) {
+    stream << ',' << name << "_ms";
+  }
+  stream << '\n';
+  const uint64_t first_frame = total_ - size();
+  for(size_t i = 0; i < size(); ++i) {
+    stream << first_frame + i;
+    for(size_t metric = 0; metric < kMetricCount; ++metric) {
+      stream << ',' << At(static_cast<FrameMetric>(metric), i);
+    }
+    stream << '\n';
+  }
+}
+
+void FrameStats::WriteJson(std::ostream& stream) const {
+  stream << "{\n  \"frames\": " << total_
+         << ",\n  \"window\": " << size()
+         << ",\n  \"histogram_bucket_ms\": " << kHistogramBucketWidth
+         << ",\n  \"metrics\": {";
+  for(size_t metric = 0; metric < kMetricCount; ++metric) {
+    const FrameStatsSummary summary = Summarize(static_cast<FrameMetric>(metric));
+    stream << (metric == 0 ? "\n" : ",\n")
+           << "    \"" << kMetricNames[metric] << "\": {"
+           << "\"min\": " << summary.min
+           << ", \"avg\": " << summary.avg
+           << ", \"p50\": " << summary.p50
+           << ", \"p95\": " << summary.p95
+           << ", \"p99\": " << summary.p99
+           << ", \"max\": " << summary.max
+           << ", \"histogram\": [";
+    const Histogram histogram = GetHistogram(static_cast<FrameMetric>(metric));
+    for(size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+      stream << (bucket == 0 ? "" : ", ") << histogram[bucket];
+    }
+    stream << "]}";
+  }
+  stream << "\n  }\n}\n";
+}
+
+} // namespace engine
@@ -0,0 +1,89 @@
+#ifndef ENGINE_FRAME_STATS_H_
+#define ENGINE_FRAME_STATS_H_
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace engine {
+
+// Times measured for every frame, in milliseconds. kFrame spans one whole
+// iteration of the main loop, kRender the RenderFrame call less presenting,
+// and kPresent the acquire and present a renderer does in RenderFrame, as
+// Vulkan does, plus what the window does after the render event, such as
+// swapping buffers.
+enum class FrameMetric {
+  kFrame,
+  kRender,
+  kPresent,
+  kCount
+};
+
+struct FrameStatsSummary {
+  double min;
+  double avg;
+  double p50;
+  double p95;
+  double p99;
+  double max;
+};
+
+// Ring buffers of the timings of the most recent frames, summarized on
+// demand so recording a frame stays a few stores.
+class FrameStats {
+public:
+  static constexpr size_t kMetricCount = static_cast<size_t>(FrameMetric::kCount);
+  // Buckets of kHistogramBucketWidth ms, the last one also counting every
+  // longer sample.
+  static constexpr size_t kHistogramBuckets = 64;
+  static constexpr double kHistogramBucketWidth = 1.0;
+
+  using Histogram = std::array<uint32_t, kHistogramBuckets>;
+
+  explicit FrameStats(size_t capacity);
+  ~FrameStats() = default;
+
+  void Add(double frame_time, double render_time, double present_time) noexcept;
+
+  // Both cover the frames still held, zero when there are none.
+  [[nodiscard]] FrameStatsSummary Summarize(FrameMetric metric) const;
+  [[nodiscard]] Histogram GetHistogram(FrameMetric metric) const noexcept;
+
+  // One row per held frame, oldest first.
+  void WriteCsv(std::ostream& stream) const;
+  // Summary and histogram of every metric.
+  void WriteJson(std::ostream& stream) const;
+
+  // Frames held, at most the capacity.
+  [[nodiscard]] size_t size() const noexcept;
+  // Frames added since construction.
+  [[nodiscard]] uint64_t total() const noexcept;
+private:
+  [[nodiscard]] double At(FrameMetric metric, size_t idx) const noexcept;
+
+  size_t capacity_;
+  size_t next_;
+  uint64_t total_;
+  std::array<std::vector<double>, kMetricCount> samples_;
+  // Sorted copy of one metric, reused across summaries.
+  mutable std::vector<double> sorted_;
+};
+
+inline size_t FrameStats::size() const noexcept {
+  return total_ < capacity_ ? static_cast<size_t>(total_) : capacity_;
+}
+
+inline uint64_t FrameStats::total() const noexcept {
+  return total_;
+}
+
+// Oldest held frame first.
+inline double FrameStats::At(const FrameMetric metric, const size_t idx) const noexcept {
+  const size_t first = total_ < capacity_ ? 0 : next_;
+  return samples_[static_cast<size_t>(metric)][(first + idx) % capacity_];
+}
+
+} // namespace engine
+
+#endif // ENGINE_FRAME_STATS_H_
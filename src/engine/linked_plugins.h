@@ -0,0 +1,27 @@
+#ifndef ENGINE_LINKED_PLUGINS_H_
+#define ENGINE_LINKED_PLUGINS_H_
+
+#include "engine/render/renderer.h"
+#include "engine/window/window.h"
+
+#ifdef ENGINE_STATIC_PLUGINS
+#include ENGINE_STATIC_RENDERER_HEADER
+#include ENGINE_STATIC_WINDOW_HEADER
+#endif // ENGINE_STATIC_PLUGINS
+
+namespace engine {
+
+// Renderer and window types the runners call. A static build names the final
+// classes it links in, so those calls bind directly instead of through the
+// vtable, while a plugin build only knows the interfaces.
+#ifdef ENGINE_STATIC_PLUGINS
+using LinkedRenderer = ENGINE_STATIC_RENDERER_CLASS;
+using LinkedWindow = ENGINE_STATIC_WINDOW_CLASS;
+#else
+using LinkedRenderer = Renderer;
+using LinkedWindow = Window;
+#endif // ENGINE_STATIC_PLUGINS
+
+} // namespace engine
+
+#endif // ENGINE_LINKED_PLUGINS_H_
@@ -3,6 +3,7 @@
 
 #include "engine/render/types.h"
 #include "obj/types.h"
+#include "trace/trace.h"
 
 #include <glm/glm.hpp>
 #include <unordered_map>
@@ -10,6 +11,7 @@
 namespace engine::data_util {
 
 static void RemoveDuplicates(const obj::Data& data, Vertex* vertices, Index* indices) {
+  TRACE_ZONE("RemoveDuplicates");
   std::unordered_map<obj::Indices, unsigned int, obj::Indices::Hash> index_map;
 
   unsigned int next_combined_idx = 0, combined_idx = 0;
@@ -31,6 +33,53 @@ static void RemoveDuplicates(const obj::Data& data, Vertex* vertices, Index* ind
   }
 }
 
+// Same as above, but vertices are also keyed by the material of the usemtl
+// range they are referenced from, which is written to materials offset by
+// material_base.
+static void RemoveDuplicates(const obj::Data& data, Vertex* vertices, Index* indices, uint32_t* materials, const uint32_t material_base) {
+  TRACE_ZONE("RemoveDuplicates");
+  struct MaterialIndices {
+    obj::Indices indices;
+    unsigned int material;
+
+    bool operator==(const MaterialIndices& other) const noexcept {
+      return other.indices == indices && other.material == material;
+    }
+  };
+  struct MaterialIndicesHash {
+    size_t operator()(const MaterialIndices& idx) const {
+      return obj::Indices::Hash()(idx.indices) ^ (std::hash<unsigned int>()(idx.material) << 1);
+    }
+  };
+  std::unordered_map<MaterialIndices, unsigned int, MaterialIndicesHash> index_map;
+
+  auto usemtl = data.usemtl.begin();
+  unsigned int next_combined_idx = 0, combined_idx = 0;
+  for (size_t i = 0; i < data.indices.size(); ++i) {
+    while (usemtl != data.usemtl.end() && i >= usemtl->offset) {
+      ++usemtl;
+    }
+    const unsigned int material = usemtl != data.usemtl.end() ? usemtl->index : 0;
+    const MaterialIndices key = {data.indices[i], material};
+    if (index_map.count(key)) {
+      combined_idx = index_map.at(key);
+    } else {
+      combined_idx = next_combined_idx;
+      index_map.emplace(key, combined_idx);
+      const obj::Indices& index = data.indices[i];
+      const unsigned int i_v = index.fv * 3, i_n = index.fn * 3, i_t = index.ft * 2;
+      *vertices++ = Vertex{
+        glm::vec3(data.v[i_v], data.v[i_v + 1], data.v[i_v + 2]),
+        glm::vec3(data.vn[i_n], data.vn[i_n + 1], data.vn[i_n + 2]),
+        glm::vec2(data.vt[i_t], data.vt[i_t + 1])
+      };
+      *materials++ = material_base + material;
+      ++next_combined_idx;
+    }
+    *indices++ = combined_idx;
+  }
+}
+
 } // namespace engine
 
 #endif // ENGINE_RENDER_DATA_UTIL_H_
@@ -8,7 +8,7 @@
 
 extern "C" {
 
-extern ENGINE_API engine::Renderer* PluginCreateRenderer(engine::Window& window);
+extern ENGINE_API engine::Renderer* PluginCreateRenderer(engine::Window& window, const engine::RendererOptions& options);
 extern ENGINE_API void PluginDestroyRenderer(engine::Renderer* renderer);
 
 } // extern "C"
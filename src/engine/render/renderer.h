@@ -1,7 +1,9 @@
 #ifndef ENGINE_RENDER_RENDERER_H_
 #define ENGINE_RENDER_RENDERER_H_
 
-#include "engine/render/model.h"
+#include <string>
+
+#include "engine/render/scene.h"
 #include "engine/window/window.h"
 
 namespace engine {
@@ -11,11 +13,39 @@ public:
   using Handle = std::unique_ptr<Renderer, void(*)(Renderer*)>;
 
   virtual void RenderFrame() = 0;
-  virtual void LoadModel(const std::string& path) = 0;
-  virtual Model& GetModel() noexcept = 0;
+  virtual MeshId LoadMesh(const std::string& path) = 0;
+  virtual Scene& GetScene() noexcept = 0;
+  [[nodiscard]] virtual DrawStats GetDrawStats() const noexcept = 0;
+  [[nodiscard]] virtual const GpuTimings& GetGpuTimings() const noexcept = 0;
+  // GPU milliseconds of the latest frame whose timing has been read back, or
+  // zero when the backend cannot measure it.
+  [[nodiscard]] double GetGpuFrameTime() const noexcept;
+  // Milliseconds the latest RenderFrame spent acquiring an image and
+  // presenting it, FIFO waits included. Zero for a backend whose window
+  // presents after RenderFrame returns, where the runner times it instead.
+  [[nodiscard]] virtual double GetPresentTime() const noexcept;
+  // With a render thread, a backend whose swapchain went out of date leaves
+  // rebuilding it, which queries the window, to RecreateSurface. The runner
+  // calls that from the window's thread while the render thread is idle.
+  [[nodiscard]] virtual bool IsSurfaceOutOfDate() const noexcept;
+  virtual void RecreateSurface();
   virtual ~Renderer() = default;
 };
 
+inline double Renderer::GetGpuFrameTime() const noexcept {
+  return GetGpuTimings().frame;
+}
+
+inline double Renderer::GetPresentTime() const noexcept {
+  return 0.0;
+}
+
+inline bool Renderer::IsSurfaceOutOfDate() const noexcept {
+  return false;
+}
+
+inline void Renderer::RecreateSurface() {}
+
 } // namespace engine
 
 #endif // ENGINE_RENDER_RENDERER_H_
@@ -4,12 +4,26 @@
 
 namespace engine {
 
+#ifdef ENGINE_STATIC_PLUGINS
+
+RendererLoader::RendererLoader(const std::string& path) {
+  CheckLinkedLibrary(path, ENGINE_STATIC_RENDERER_NAME "_renderer");
+}
+
+Renderer::Handle RendererLoader::Load(Window& window, const RendererOptions& options) const {
+  return {PluginCreateRenderer(window, options), PluginDestroyRenderer};
+}
+
+#else
+
 RendererLoader::RendererLoader(const std::string& path) : DllLoader(path) {}
 
-Renderer::Handle RendererLoader::Load(Window& window) const {
+Renderer::Handle RendererLoader::Load(Window& window, const RendererOptions& options) const {
   const auto create_renderer = DllLoader::Load<decltype(&PluginCreateRenderer)>("PluginCreateRenderer");
   const auto destroy_renderer = DllLoader::Load<decltype(&PluginDestroyRenderer)>("PluginDestroyRenderer");
-  return {create_renderer(window), destroy_renderer};
+  return {create_renderer(window, options), destroy_renderer};
 }
 
+#endif // ENGINE_STATIC_PLUGINS
+
 } // namespace engine
\ No newline at end of file
@@ -10,7 +10,7 @@ class RendererLoader final : DllLoader {
 public:
   explicit RendererLoader(const std::string& path);
 
-  [[nodiscard]] Renderer::Handle Load(Window& window) const;
+  [[nodiscard]] Renderer::Handle Load(Window& window, const RendererOptions& options) const;
 
   ~RendererLoader() override = default;
 };
@@ -0,0 +1,414 @@
+#ifndef ENGINE_RENDER_SCENE_H_
+#define ENGINE_RENDER_SCENE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "engine/render/types.h"
+
+namespace engine {
+
+// Consecutive entries of the transforms written by Scene::CopyTransforms.
+struct InstanceRange {
+  uint32_t first_instance;
+  uint32_t instance_count;
+};
+
+// Many copies of one mesh drawn with a single instanced draw per submesh.
+struct InstanceBatch {
+  InstancesId id;
+  MeshId mesh;
+  std::vector<glm::mat4> transforms;
+  // Transforms version of the latest change to the batch.
+  uint64_t version;
+};
+
+// Camera uniforms plus the transforms of every object in the scene. Objects
+// are packed densely as a structure of arrays, so per-frame matrix updates
+// walk contiguous arrays and disjoint slot ranges can be updated in parallel.
+// Every change to a slot or an instance batch stamps it with a new
+// transforms version, so a static scene costs no matrix updates and readers
+// can tell which slots changed since a version they saw.
+class Scene {
+public:
+  Scene();
+
+  // The camera looks from (2, 2, 2) at the origin, z up, until it is set.
+  void SetViewport(int width, int height) noexcept;
+  void SetCamera(const glm::vec3& eye, const glm::vec3& target) noexcept;
+  // Fixed near and far planes. Without them the planes follow the eye to
+  // target distance, so a camera moved away does not clip the scene.
+  void SetClipPlanes(float near_plane, float far_plane) noexcept;
+
+  [[nodiscard]] ObjectId AddObject(MeshId mesh);
+  void RemoveObject(ObjectId id);
+
+  void SetTransform(ObjectId id, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+  void SetTranslation(ObjectId id, const glm::vec3& translation);
+  void SetRotation(ObjectId id, const glm::quat& rotation);
+  void SetScale(ObjectId id, const glm::vec3& scale);
+
+  [[nodiscard]] InstancesId AddInstances(MeshId mesh, const glm::mat4* transforms, size_t count);
+  void SetInstances(InstancesId id, const glm::mat4* transforms, size_t count);
+  void RemoveInstances(InstancesId id);
+
+  // Recomputes the matrices of the slots changed since the last full update.
+  // The ranged form leaves them marked, so it is for splitting one update
+  // across threads before a full update would run.
+  void UpdateTransforms() noexcept;
+  void UpdateTransforms(size_t first, size_t last) noexcept;
+
+  [[nodiscard]] const Uniforms& GetUniforms() const noexcept;
+  [[nodiscard]] uint64_t GetUniformsVersion() const noexcept;
+  // Changes whenever objects or instances are added or removed, or an
+  // instance batch is resized. Transform updates leave it untouched.
+  [[nodiscard]] uint64_t GetLayoutVersion() const noexcept;
+  // Changes whenever a transform or the layout does.
+  [[nodiscard]] uint64_t GetTransformsVersion() const noexcept;
+  // Transforms version of the latest change to the slot.
+  [[nodiscard]] uint64_t GetSlotVersion(size_t slot) const noexcept;
+
+  [[nodiscard]] size_t GetObjectCount() const noexcept;
+  [[nodiscard]] const std::vector<MeshId>& GetMeshes() const noexcept;
+  [[nodiscard]] const std::vector<glm::mat4>& GetTransforms() const noexcept;
+  [[nodiscard]] const std::vector<InstanceBatch>& GetInstanceBatches() const noexcept;
+  [[nodiscard]] size_t GetInstanceCount() const noexcept;
+
+  // Brings a copy of scene, made or brought up to date from it earlier, up
+  // to date again. With the layout unchanged only the uniforms, slots and
+  // instance batches changed since are copied, at the cost of comparing one
+  // version per slot and batch. The matrices of copied slots are left to
+  // UpdateTransforms. Otherwise the whole scene is copied.
+  void CopyChangesFrom(const Scene& scene);
+
+  // Writes the object transforms followed by every instance batch,
+  // GetObjectCount() + GetInstanceCount() matrices in total.
+  void CopyTransforms(glm::mat4* transforms) const noexcept;
+  // Buckets the ranges of the CopyTransforms output by mesh, adjacent
+  // objects of one mesh sharing a range.
+  void CollectInstanceRanges(std::vector<std::vector<InstanceRange>>& mesh_ranges) const;
+private:
+  // Near and far planes of a camera without clip planes of its own, as
+  // multiples of the eye to target distance, about 0.1 and 10 from the
+  // default eye.
+  static constexpr float kNearPlaneDistance = 0.03f;
+  static constexpr float kFarPlaneDistance = 3.0f;
+
+  void UpdateUniforms() noexcept;
+
+  glm::vec3 eye_;
+  glm::vec3 target_;
+  float aspect_;
+  // Zero far plane when they follow the camera.
+  float near_plane_;
+  float far_plane_;
+  Uniforms uniforms_;
+  uint64_t uniforms_version_;
+  uint64_t layout_version_;
+
+  std::vector<ObjectId> ids_;
+  std::vector<MeshId> meshes_;
+  std::vector<glm::vec3> translations_;
+  std::vector<glm::quat> rotations_;
+  std::vector<glm::vec3> scales_;
+  std::vector<glm::mat4> transforms_;
+  std::vector<uint64_t> slot_versions_;
+  uint64_t transforms_version_;
+  // Transforms version at the last full UpdateTransforms.
+  uint64_t updated_version_;
+
+  std::vector<uint32_t> slots_;
+  std::vector<ObjectId> free_ids_;
+
+  std::vector<InstanceBatch> batches_;
+  std::vector<uint32_t> batch_slots_;
+  std::vector<InstancesId> free_batch_ids_;
+  size_t instance_count_;
+};
+
+inline Scene::Scene()
+  : eye_(2.0f, 2.0f, 2.0f), target_(0.0f, 0.0f, 0.0f), aspect_(1.0f), near_plane_(0.0f), far_plane_(0.0f),
+    uniforms_(), uniforms_version_(0), layout_version_(0), transforms_version_(0), updated_version_(0), instance_count_(0) {}
+
+inline void Scene::SetViewport(const int width, const int height) noexcept {
+  aspect_ = static_cast<float>(width) / static_cast<float>(std::max(height, 1));
+  UpdateUniforms();
+}
+
+inline void Scene::SetCamera(const glm::vec3& eye, const glm::vec3& target) noexcept {
+  eye_ = eye;
+  target_ = target;
+  UpdateUniforms();
+}
+
+inline void Scene::SetClipPlanes(const float near_plane, const float far_plane) noexcept {
+  near_plane_ = near_plane;
+  far_plane_ = far_plane;
+  UpdateUniforms();
+}
+
+inline void Scene::UpdateUniforms() noexcept {
+  float near_plane = near_plane_;
+  float far_plane = far_plane_;
+  if (far_plane_ <= 0.0f) {
+    const float distance = std::max(glm::length(target_ - eye_), 1e-3f);
+    near_plane = kNearPlaneDistance * distance;
+    far_plane = kFarPlaneDistance * distance;
+  }
+  uniforms_.view = glm::lookAt(eye_, target_, glm::vec3(0.0f, 0.0f, 1.0f));
+  uniforms_.proj = glm::perspective(glm::radians(45.0f), aspect_, near_plane, far_plane);
+  uniforms_.proj[1][1] *= -1;
+  ++uniforms_version_;
+}
+
+inline ObjectId Scene::AddObject(const MeshId mesh) {
+  ObjectId id;
+  if (!free_ids_.empty()) {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  } else {
+    id = static_cast<ObjectId>(slots_.size());
+    slots_.emplace_back();
+  }
+  slots_[id] = static_cast<uint32_t>(ids_.size());
+
+  ids_.push_back(id);
+  meshes_.push_back(mesh);
+  translations_.emplace_back(0.0f);
+  rotations_.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+  scales_.emplace_back(1.0f);
+  transforms_.emplace_back(1.0f);
+  slot_versions_.push_back(++transforms_version_);
+  ++layout_version_;
+
+  return id;
+}
+
+inline void Scene::RemoveObject(const ObjectId id) {
+  const uint32_t slot = slots_[id];
+  const uint32_t last = static_cast<uint32_t>(ids_.size() - 1);
+
+  ids_[slot] = ids_[last];
+  meshes_[slot] = meshes_[last];
+  translations_[slot] = translations_[last];
+  rotations_[slot] = rotations_[last];
+  scales_[slot] = scales_[last];
+  transforms_[slot] = transforms_[last];
+  slot_versions_[slot] = ++transforms_version_;
+  slots_[ids_[slot]] = slot;
+
+  ids_.pop_back();
+  meshes_.pop_back();
+  translations_.pop_back();
+  rotations_.pop_back();
+  scales_.pop_back();
+  transforms_.pop_back();
+  slot_versions_.pop_back();
+
+  free_ids_.push_back(id);
+  ++layout_version_;
+}
+
+inline void Scene::SetTransform(const ObjectId id, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+  const uint32_t slot = slots_[id];
+  translations_[slot] = translation;
+  rotations_[slot] = rotation;
+  scales_[slot] = scale;
+  slot_versions_[slot] = ++transforms_version_;
+}
+
+inline void Scene::SetTranslation(const ObjectId id, const glm::vec3& translation) {
+  const uint32_t slot = slots_[id];
+  translations_[slot] = translation;
+  slot_versions_[slot] = ++transforms_version_;
+}
+
+inline void Scene::SetRotation(const ObjectId id, const glm::quat& rotation) {
+  const uint32_t slot = slots_[id];
+  rotations_[slot] = rotation;
+  slot_versions_[slot] = ++transforms_version_;
+}
+
+inline void Scene::SetScale(const ObjectId id, const glm::vec3& scale) {
+  const uint32_t slot = slots_[id];
+  scales_[slot] = scale;
+  slot_versions_[slot] = ++transforms_version_;
+}
+
+inline InstancesId Scene::AddInstances(const MeshId mesh, const glm::mat4* transforms, const size_t count) {
+  InstancesId id;
+  if (!free_batch_ids_.empty()) {
+    id = free_batch_ids_.back();
+    free_batch_ids_.pop_back();
+  } else {
+    id = static_cast<InstancesId>(batch_slots_.size());
+    batch_slots_.emplace_back();
+  }
+  batch_slots_[id] = static_cast<uint32_t>(batches_.size());
+  batches_.push_back({id, mesh, std::vector<glm::mat4>(transforms, transforms + count), ++transforms_version_});
+  instance_count_ += count;
+  ++layout_version_;
+
+  return id;
+}
+
+inline void Scene::SetInstances(const InstancesId id, const glm::mat4* transforms, const size_t count) {
+  InstanceBatch& batch = batches_[batch_slots_[id]];
+  if (batch.transforms.size() != count) {
+    ++layout_version_;
+  }
+  instance_count_ = instance_count_ - batch.transforms.size() + count;
+  batch.transforms.assign(transforms, transforms + count);
+  batch.version = ++transforms_version_;
+}
+
+inline void Scene::RemoveInstances(const InstancesId id) {
+  const uint32_t slot = batch_slots_[id];
+  instance_count_ -= batches_[slot].transforms.size();
+
+  if (slot != batches_.size() - 1) {
+    batches_[slot] = std::move(batches_.back());
+    batch_slots_[batches_[slot].id] = slot;
+  }
+  batches_.pop_back();
+
+  free_batch_ids_.push_back(id);
+  ++transforms_version_;
+  ++layout_version_;
+}
+
+inline void Scene::UpdateTransforms() noexcept {
+  if (updated_version_ == transforms_version_) {
+    return;
+  }
+  UpdateTransforms(0, transforms_.size());
+  updated_version_ = transforms_version_;
+}
+
+inline void Scene::UpdateTransforms(const size_t first, const size_t last) noexcept {
+  for(size_t i = first; i < last; ++i) {
+    if (slot_versions_[i] <= updated_version_) {
+      continue;
+    }
+    const glm::vec3& scale = scales_[i];
+    glm::mat4 transform = glm::mat4_cast(rotations_[i]);
+    transform[0] *= scale.x;
+    transform[1] *= scale.y;
+    transform[2] *= scale.z;
+    transform[3] = glm::vec4(translations_[i], 1.0f);
+
+    transforms_[i] = transform;
+  }
+}
+
+inline const Uniforms& Scene::GetUniforms() const noexcept {
+  return uniforms_;
+}
+
+inline uint64_t Scene::GetUniformsVersion() const noexcept {
+  return uniforms_version_;
+}
+
+inline uint64_t Scene::GetLayoutVersion() const noexcept {
+  return layout_version_;
+}
+
+inline uint64_t Scene::GetTransformsVersion() const noexcept {
+  return transforms_version_;
+}
+
+inline uint64_t Scene::GetSlotVersion(const size_t slot) const noexcept {
+  return slot_versions_[slot];
+}
+
+inline size_t Scene::GetObjectCount() const noexcept {
+  return ids_.size();
+}
+
+inline const std::vector<MeshId>& Scene::GetMeshes() const noexcept {
+  return meshes_;
+}
+
+inline const std::vector<glm::mat4>& Scene::GetTransforms() const noexcept {
+  return transforms_;
+}
+
+inline const std::vector<InstanceBatch>& Scene::GetInstanceBatches() const noexcept {
+  return batches_;
+}
+
+inline size_t Scene::GetInstanceCount() const noexcept {
+  return instance_count_;
+}
+
+inline void Scene::CopyChangesFrom(const Scene& scene) {
+  if (layout_version_ != scene.layout_version_) {
+    *this = scene;
+    return;
+  }
+  if (uniforms_version_ != scene.uniforms_version_) {
+    eye_ = scene.eye_;
+    target_ = scene.target_;
+    aspect_ = scene.aspect_;
+    near_plane_ = scene.near_plane_;
+    far_plane_ = scene.far_plane_;
+    uniforms_ = scene.uniforms_;
+    uniforms_version_ = scene.uniforms_version_;
+  }
+  if (transforms_version_ == scene.transforms_version_) {
+    return;
+  }
+  for(size_t i = 0; i < ids_.size(); ++i) {
+    if (scene.slot_versions_[i] > transforms_version_) {
+      translations_[i] = scene.translations_[i];
+      rotations_[i] = scene.rotations_[i];
+      scales_[i] = scene.scales_[i];
+      slot_versions_[i] = scene.slot_versions_[i];
+    }
+  }
+  for(size_t i = 0; i < batches_.size(); ++i) {
+    if (scene.batches_[i].version > transforms_version_) {
+      batches_[i].transforms = scene.batches_[i].transforms;
+      batches_[i].version = scene.batches_[i].version;
+    }
+  }
+  transforms_version_ = scene.transforms_version_;
+}
+
+inline void Scene::CopyTransforms(glm::mat4* transforms) const noexcept {
+  transforms = std::copy(transforms_.begin(), transforms_.end(), transforms);
+  for(const InstanceBatch& batch : batches_) {
+    transforms = std::copy(batch.transforms.begin(), batch.transforms.end(), transforms);
+  }
+}
+
+inline void Scene::CollectInstanceRanges(std::vector<std::vector<InstanceRange>>& mesh_ranges) const {
+  for(std::vector<InstanceRange>& ranges : mesh_ranges) {
+    ranges.clear();
+  }
+  // Runs of consecutive slots sharing a mesh become one range.
+  uint32_t first_instance = 0;
+  for(; first_instance < meshes_.size(); ++first_instance) {
+    std::vector<InstanceRange>& ranges = mesh_ranges[meshes_[first_instance]];
+    if (!ranges.empty() && ranges.back().first_instance + ranges.back().instance_count == first_instance) {
+      ++ranges.back().instance_count;
+    } else {
+      ranges.push_back({first_instance, 1});
+    }
+  }
+  for(const InstanceBatch& batch : batches_) {
+    const auto instance_count = static_cast<uint32_t>(batch.transforms.size());
+    if (instance_count != 0) {
+      mesh_ranges[batch.mesh].push_back({first_instance, instance_count});
+    }
+    first_instance += instance_count;
+  }
+}
+
+} // namespace engine
+
+#endif // ENGINE_RENDER_SCENE_H_
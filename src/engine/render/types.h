@@ -2,6 +2,7 @@
 #define ENGINE_RENDER_TYPES_H_
 
 #include <cstdint>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -16,8 +17,77 @@ struct Vertex {
 
 using Index = uint32_t;
 
+using MeshId = uint32_t;
+using ObjectId = uint32_t;
+using InstancesId = uint32_t;
+
+// Draw command instances of the last completed frame that were submitted
+// and that culling rejected.
+struct DrawStats {
+  uint32_t drawn;
+  uint32_t culled;
+};
+
+// GPU milliseconds of one pass of a frame, passes being listed in the order
+// the GPU runs them.
+struct GpuPassTime {
+  const char* name;
+  double time;
+};
+
+// GPU milliseconds spent drawing one usemtl group of a mesh. A bindless
+// Vulkan mesh is drawn as a single group of material 0.
+struct GpuGroupTime {
+  MeshId mesh;
+  uint32_t material;
+  double time;
+};
+
+// Timings of the latest frame whose queries have been read back, which
+// trails the frame being recorded by the frames in flight. Everything is
+// empty or zero when the backend cannot measure GPU time.
+struct GpuTimings {
+  double frame;
+  std::vector<GpuPassTime> passes;
+  std::vector<GpuGroupTime> groups;
+};
+
+// How finished frames are handed to the display. kLowestLatency picks the
+// first available of immediate, mailbox, relaxed FIFO and FIFO. Backends
+// fall back to FIFO, which is always available, for unsupported modes.
+enum class PresentMode {
+  kFifo,
+  kFifoRelaxed,
+  kMailbox,
+  kImmediate,
+  kLowestLatency
+};
+
+// More frames in flight let the CPU run further ahead of the GPU, trading
+// input latency for throughput. A swapchain image count of zero lets the
+// backend pick one more than the surface minimum.
+struct RendererOptions {
+  PresentMode present_mode;
+  uint32_t frames_in_flight;
+  uint32_t swapchain_images;
+  // RenderFrame is called from a thread of its own while the window's thread
+  // handles events, so it must not make window system calls.
+  bool render_thread;
+  // Vulkan: one descriptor array holds every material texture, selected by
+  // a per-vertex material index, when descriptor indexing is supported.
+  bool bindless;
+  // Vulkan: pipelines are compiled through a VkPipelineCache kept in the user
+  // cache directory between runs.
+  bool pipeline_cache;
+  // Vulkan: draws are culled by a compute pass against the frustum and a
+  // depth pyramid of the previous frame, one draw per visible instance.
+  bool gpu_culling;
+  // GPU timestamps around the frame and each draw group, read back a few
+  // frames late, when the device supports them.
+  bool gpu_profiler;
+};
+
 struct Uniforms {
-  alignas(16) glm::mat4 model;
   alignas(16) glm::mat4 view;
   alignas(16) glm::mat4 proj;
 };
@@ -0,0 +1,104 @@
+#include "engine/render_thread.h"
+
+#include <chrono>
+#include <utility>
+
+#include "trace/trace.h"
+
+namespace engine {
+
+RenderThread::RenderThread(LinkedRenderer& renderer)
+    : renderer_(renderer),
+      has_pending_(false),
+      busy_(false),
+      closed_(false),
+      last_frame_(),
+      thread_(&RenderThread::Work, this) {}
+
+RenderThread::~RenderThread() {
+  Join();
+}
+
+void RenderThread::Submit(const Scene& scene) {
+  // Copied before taking the lock, the render thread never touches back_.
+  back_.CopyChangesFrom(scene);
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return !has_pending_ || error_ != nullptr; });
+  RethrowError();
+  std::swap(back_, pending_);
+  has_pending_ = true;
+  cv_.notify_all();
+}
+
+void RenderThread::WaitIdle() {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return (!has_pending_ && !busy_) || error_ != nullptr; });
+  RethrowError();
+}
+
+void RenderThread::Close() {
+  Join();
+  const std::lock_guard lock(mutex_);
+  RethrowError();
+}
+
+void RenderThread::GetLastFrame(RenderedFrame& frame) const {
+  const std::lock_guard lock(mutex_);
+  frame = last_frame_;
+}
+
+void RenderThread::Work() {
+  TRACE_THREAD_NAME("render");
+  std::unique_lock lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return has_pending_ || closed_; });
+    if (!has_pending_) {
+      return;
+    }
+    // The renderer's previous scene becomes the next pending slot.
+    std::swap(pending_, renderer_.GetScene());
+    has_pending_ = false;
+    busy_ = true;
+    cv_.notify_all();
+    lock.unlock();
+
+    const auto render_begin = std::chrono::steady_clock::now();
+    try {
+      renderer_.RenderFrame();
+    } catch (...) {
+      lock.lock();
+      error_ = std::current_exception();
+      busy_ = false;
+      cv_.notify_all();
+      return;
+    }
+    const auto render_end = std::chrono::steady_clock::now();
+
+    lock.lock();
+    busy_ = false;
+    last_frame_.render_time = std::chrono::duration<double, std::milli>(render_end - render_begin).count();
+    last_frame_.present_time = renderer_.GetPresentTime();
+    last_frame_.draw_stats = renderer_.GetDrawStats();
+    last_frame_.gpu_timings = renderer_.GetGpuTimings();
+    cv_.notify_all();
+  }
+}
+
+void RenderThread::Join() {
+  {
+    const std::lock_guard lock(mutex_);
+    closed_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void RenderThread::RethrowError() const {
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+}
+
+} // namespace engine
@@ -0,0 +1,74 @@
+#ifndef ENGINE_RENDER_THREAD_H_
+#define ENGINE_RENDER_THREAD_H_
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "engine/linked_plugins.h"
+#include "engine/render/renderer.h"
+
+namespace engine {
+
+// What the renderer reported of its latest frame.
+struct RenderedFrame {
+  // Milliseconds spent in RenderFrame, present_time of them presenting.
+  double render_time;
+  double present_time;
+  DrawStats draw_stats;
+  GpuTimings gpu_timings;
+};
+
+// Calls RenderFrame on a thread of its own. The window's thread updates a
+// scene of its own and submits snapshots of it: a submitted snapshot waits in
+// a pending slot until the render thread swaps it with the renderer's scene,
+// so the window's thread can build the next one meanwhile and is held back
+// only when it gets a whole frame ahead. The three scenes are recycled by
+// swapping, and a snapshot is brought up to date with Scene::CopyChangesFrom,
+// so a submit copies what changed in the last three frames, not the scene.
+class RenderThread {
+public:
+  explicit RenderThread(LinkedRenderer& renderer);
+  ~RenderThread();
+
+  RenderThread(const RenderThread&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+
+  // Errors of the render thread are rethrown by the next of these calls.
+  void Submit(const Scene& scene);
+  // Returns once every submitted frame has been rendered, leaving the
+  // renderer to the calling thread until the next Submit.
+  void WaitIdle();
+  // Renders what is still pending and joins the thread.
+  void Close();
+
+  // Copied under the lock, so the window's thread never reads the renderer
+  // while it records.
+  void GetLastFrame(RenderedFrame& frame) const;
+private:
+  void Work();
+  void Join();
+  // Called with the lock held.
+  void RethrowError() const;
+
+  LinkedRenderer& renderer_;
+  // Written by Submit without the lock, it is only swapped under it. Every
+  // snapshot descends from the submitted scene, as CopyChangesFrom needs.
+  Scene back_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  Scene pending_;
+  bool has_pending_;
+  bool busy_;
+  bool closed_;
+  std::exception_ptr error_;
+  RenderedFrame last_frame_;
+
+  std::thread thread_;
+};
+
+} // namespace engine
+
+#endif // ENGINE_RENDER_THREAD_H_
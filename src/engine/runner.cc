@@ -1,40 +1,212 @@
 #include "engine/runner.h"
 
+#include <fstream>
+#include <iomanip>
+#include <iostream>
 #include <sstream>
 
+#include "engine/cast_util.h"
+#include "trace/trace.h"
+
 namespace engine {
 
-Runner::Runner(const RendererLoader& renderer_loader, const WindowLoader& window_loader, std::string title)
-    : title_(std::move(title)),
+namespace {
+
+// Frames kept for the statistics, shown in the title and written on exit.
+constexpr size_t kFrameStatsCapacity = 8192;
+// Setting the title is a round trip to the window system, so it is only
+// refreshed this often.
+constexpr std::chrono::milliseconds kTitleInterval(500);
+constexpr const char* kDefaultModel = "../obj/Madara Uchiha/obj/Madara_Uchiha.obj";
+// Frame limit of runs whose window never closes, when neither
+// ENGINE_FRAME_LIMIT nor the scenario sets one.
+constexpr uint64_t kWindowlessFrameLimit = 1000;
+
+double Milliseconds(const std::chrono::steady_clock::duration duration) noexcept {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+Runner::Runner(const RendererLoader& renderer_loader, const WindowLoader& window_loader, const Config& config)
+    : title_(config.title),
+      benchmark_(config.benchmark),
+      frames_in_flight_(config.renderer_options.frames_in_flight),
+      frame_limit_(config.frame_limit),
+      frame_count_(0),
+      frame_stats_path_(config.frame_stats_path),
+      use_render_thread_(config.renderer_options.render_thread),
       window_loader_(window_loader),
       renderer_loader_(renderer_loader),
+      frame_stats_(kFrameStatsCapacity),
+      render_time_(0.0),
+      present_time_(0.0),
+      last_frame_(),
+      title_frames_(0),
+      benchmark_gpu_time_(0.0),
+      benchmark_gpu_frames_(0),
+      scenario_(config.scenario_path.empty() ? Scenario::FromModel(kDefaultModel) : Scenario::FromFile(config.scenario_path)),
       instance_(window_loader_.LoadInstance()),
-      window_(window_loader_.LoadWindow(1280, 720, title_)),
-      renderer_(renderer_loader_.Load(*window_)) {}
+      window_handle_(window_loader_.LoadWindow(1280, 720, title_)),
+      renderer_handle_(renderer_loader_.Load(*window_handle_, config.renderer_options)),
+      window_(NAMED_DYNAMIC_CAST(LinkedWindow&, *window_handle_)),
+      renderer_(NAMED_DYNAMIC_CAST(LinkedRenderer&, *renderer_handle_)) {
+  if (frame_limit_ == 0) {
+    frame_limit_ = scenario_.frame_count();
+  }
+  if (frame_limit_ == 0 && !window_.IsClosable()) {
+    frame_limit_ = kWindowlessFrameLimit;
+  }
+}
 
 void Runner::Run() {
-  renderer_->LoadModel("../obj/Madara Uchiha/obj/Madara_Uchiha.obj");
-  renderer_->GetModel().SetView(window_->GetWidth(), window_->GetHeight());
-  window_->SetWindowEventHandler(this);
-  while (!window_->ShouldClose()) {
-    UpdateFps();
-    window_->Loop();
+  objects_ = scenario_.Load(renderer_);
+  renderer_.GetScene().SetViewport(window_.GetWidth(), window_.GetHeight());
+  if (use_render_thread_) {
+    scene_ = renderer_.GetScene();
+    render_thread_ = std::make_unique<RenderThread>(renderer_);
+  }
+  window_.SetWindowEventHandler(this);
+  benchmark_begin_ = Clock::now();
+  title_update_ = benchmark_begin_;
+  Clock::time_point frame_begin = benchmark_begin_;
+  while (!window_.ShouldClose() && (frame_limit_ == 0 || frame_count_ < frame_limit_)) {
+    TRACE_ZONE("frame");
+    event_end_ = frame_begin;
+    render_time_ = 0.0;
+    present_time_ = 0.0;
+    window_.Loop();
+    // Resizing queries the window, so it happens here with the render
+    // thread parked rather than on the render thread.
+    if (render_thread_ != nullptr && renderer_.IsSurfaceOutOfDate()) {
+      render_thread_->WaitIdle();
+      renderer_.RecreateSurface();
+    }
+    const Clock::time_point frame_end = Clock::now();
+    frame_stats_.Add(Milliseconds(frame_end - frame_begin), render_time_, present_time_ + Milliseconds(frame_end - event_end_));
+    frame_begin = frame_end;
+    UpdateTitle(frame_end);
+  }
+  if (render_thread_ != nullptr) {
+    render_thread_->Close();
   }
+  if (benchmark_) {
+    ReportBenchmark();
+  }
+  if (!frame_stats_path_.empty()) {
+    WriteFrameStats();
+  }
+  TRACE_FLUSH();
 }
 
+// With a render thread the render and present times are those of the latest
+// frame the thread finished, which lags the submitted one.
 void Runner::OnRenderEvent() {
-  renderer_->GetModel().Rotate(1.0);
-  renderer_->RenderFrame();
+  if (render_thread_ != nullptr) {
+    scenario_.Apply(scene_, objects_, frame_count_);
+    render_thread_->Submit(scene_);
+    event_end_ = Clock::now();
+    render_thread_->GetLastFrame(last_frame_);
+  } else {
+    scenario_.Apply(renderer_.GetScene(), objects_, frame_count_);
+    const Clock::time_point render_begin = Clock::now();
+    renderer_.RenderFrame();
+    event_end_ = Clock::now();
+    last_frame_.render_time = Milliseconds(event_end_ - render_begin);
+    last_frame_.present_time = renderer_.GetPresentTime();
+    last_frame_.draw_stats = renderer_.GetDrawStats();
+    last_frame_.gpu_timings = renderer_.GetGpuTimings();
+  }
+  render_time_ = last_frame_.render_time - last_frame_.present_time;
+  present_time_ = last_frame_.present_time;
+  ++frame_count_;
+  TRACE_COUNTER("drawn", last_frame_.draw_stats.drawn);
+  TRACE_COUNTER("gpu frame ms", last_frame_.gpu_timings.frame);
+  if (benchmark_) {
+    if (const GpuTimings& timings = last_frame_.gpu_timings; timings.frame > 0.0) {
+      benchmark_gpu_time_ += timings.frame;
+      ++benchmark_gpu_frames_;
+      benchmark_pass_times_.resize(timings.passes.size());
+      for(size_t i = 0; i < timings.passes.size(); ++i) {
+        benchmark_pass_times_[i] += timings.passes[i].time;
+      }
+    }
+  }
 }
 
-void Runner::UpdateFps() {
-  const double fps = fps_counter_.Count();
+void Runner::UpdateTitle(const Clock::time_point now) {
+  ++title_frames_;
+  const Clock::duration elapsed = now - title_update_;
+  if (elapsed < kTitleInterval) {
+    return;
+  }
+  const double fps = static_cast<double>(title_frames_) * 1000.0 / Milliseconds(elapsed);
+  title_update_ = now;
+  title_frames_ = 0;
+
+  const FrameStatsSummary frame_summary = frame_stats_.Summarize(FrameMetric::kFrame);
+  const DrawStats& draw_stats = last_frame_.draw_stats;
 
   std::stringstream oss;
   oss.precision(1);
-  oss << title_ << " (" << std::fixed << fps << " FPS)";
+  oss << title_ << " (" << std::fixed << fps << " FPS, p99 " << std::setprecision(2) << frame_summary.p99 << " ms, "
+      << draw_stats.drawn << " drawn, " << draw_stats.culled << " culled" << std::setprecision(1);
+  // Each frame in flight lets the CPU run one more frame ahead of the GPU,
+  // so input can take that many frame times to reach the screen.
+  if (fps > 0.0) {
+    oss << ", " << frames_in_flight_ << " in flight ~" << frames_in_flight_ * 1000.0 / fps << " ms latency";
+  }
+  // The GPU-bound limit is the frame rate the GPU alone could sustain.
+  if (const double gpu_time = last_frame_.gpu_timings.frame; benchmark_ && gpu_time > 0.0) {
+    oss << ", GPU " << std::setprecision(2) << gpu_time << " ms, GPU-bound "
+        << std::setprecision(1) << 1000.0 / gpu_time << " FPS";
+  }
+  oss << ')';
+
+  window_.SetWindowTitle(oss.str());
+}
 
-  window_->SetWindowTitle(oss.str());
+void Runner::ReportBenchmark() const {
+  if (frame_count_ == 0) {
+    std::cout << "benchmark: no frames rendered" << std::endl;
+    return;
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - benchmark_begin_;
+  const FrameStatsSummary frame_summary = frame_stats_.Summarize(FrameMetric::kFrame);
+  std::cout << "benchmark: " << frame_count_ << " frames in " << elapsed.count() << " s, "
+            << static_cast<double>(frame_count_) / elapsed.count() << " FPS, frame p50 " << frame_summary.p50
+            << " ms p95 " << frame_summary.p95 << " ms p99 " << frame_summary.p99 << " ms, "
+            << frames_in_flight_ << " frames in flight ~" << frames_in_flight_ * elapsed.count() * 1000.0 / static_cast<double>(frame_count_) << " ms latency";
+  if (benchmark_gpu_frames_ != 0) {
+    const double gpu_time = benchmark_gpu_time_ / static_cast<double>(benchmark_gpu_frames_);
+    std::cout << ", GPU " << gpu_time << " ms/frame, GPU-bound limit " << 1000.0 / gpu_time << " FPS";
+
+    const std::vector<GpuPassTime>& passes = last_frame_.gpu_timings.passes;
+    for(size_t i = 0; i < passes.size() && i < benchmark_pass_times_.size(); ++i) {
+      std::cout << (i == 0 ? " (" : ", ") << passes[i].name << ' '
+                << benchmark_pass_times_[i] / static_cast<double>(benchmark_gpu_frames_) << " ms";
+    }
+    if (!passes.empty()) {
+      std::cout << ')';
+    }
+  }
+  std::cout << std::endl;
+}
+
+// A .json path gets the summaries and histograms, anything else one CSV
+// row per frame.
+void Runner::WriteFrameStats() const {
+  std::ofstream file(frame_stats_path_);
+  if (!file) {
+    std::cerr << "failed to open frame stats file " << frame_stats_path_ << std::endl;
+    return;
+  }
+  const bool json = frame_stats_path_.size() >= 5 && frame_stats_path_.compare(frame_stats_path_.size() - 5, 5, ".json") == 0;
+  if (json) {
+    frame_stats_.WriteJson(file);
+  } else {
+    frame_stats_.WriteCsv(file);
+  }
 }
 
 } // namespace engine
\ No newline at end of file
@@ -1,33 +1,70 @@
 #ifndef ENGINE_RUNNER_H_
 #define ENGINE_RUNNER_H_
 
+#include <chrono>
+#include <memory>
 #include <string_view>
+#include <vector>
 
+#include "engine/config.h"
+#include "engine/frame_stats.h"
+#include "engine/linked_plugins.h"
+#include "engine/render_thread.h"
+#include "engine/scenario.h"
 #include "engine/window/window_loader.h"
 #include "engine/render/renderer_loader.h"
-#include "engine/fps_counter.h"
 
 namespace engine {
 
 class Runner final : public Window::EventHandler {
 public:
-  Runner(const RendererLoader& renderer_loader, const WindowLoader& window_loader, std::string title);
+  Runner(const RendererLoader& renderer_loader, const WindowLoader& window_loader, const Config& config);
   ~Runner() override = default;
 
   void Run();
 private:
+  using Clock = std::chrono::steady_clock;
+
   void OnRenderEvent() override;
-  void UpdateFps();
+  void UpdateTitle(Clock::time_point now);
+  void ReportBenchmark() const;
+  void WriteFrameStats() const;
 
   std::string title_;
+  bool benchmark_;
+  uint32_t frames_in_flight_;
+  uint64_t frame_limit_;
+  uint64_t frame_count_;
+  std::string frame_stats_path_;
+  bool use_render_thread_;
 
   const WindowLoader& window_loader_;
   const RendererLoader& renderer_loader_;
 
-  FpsCounter fps_counter_;
+  FrameStats frame_stats_;
+  // RenderFrame's share of the frame and the part of it spent presenting.
+  double render_time_;
+  double present_time_;
+  RenderedFrame last_frame_;
+  Clock::time_point event_end_;
+  Clock::time_point title_update_;
+  uint64_t title_frames_;
+
+  Clock::time_point benchmark_begin_;
+  double benchmark_gpu_time_;
+  size_t benchmark_gpu_frames_;
+  std::vector<double> benchmark_pass_times_;
+  Scenario scenario_;
+  std::vector<ObjectId> objects_;
   Instance::Handle instance_;
-  Window::Handle window_;
-  Renderer::Handle renderer_;
+  Window::Handle window_handle_;
+  Renderer::Handle renderer_handle_;
+  LinkedWindow& window_;
+  LinkedRenderer& renderer_;
+  // With a render thread the scenario updates this scene, snapshots of which
+  // are submitted to the thread. Joined before the renderer is destroyed.
+  Scene scene_;
+  std::unique_ptr<RenderThread> render_thread_;
 };
 
 } // namespace engine
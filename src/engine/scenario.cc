@@ -0,0 +1,189 @@
+#include "engine/scenario.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "engine/error.h"
+
+namespace engine {
+
+namespace {
+
+// Trims the leading and trailing whitespace of the rest of the stream.
+std::string ReadRest(std::istream& stream) {
+  std::string rest;
+  std::getline(stream >> std::ws, rest);
+  rest.erase(rest.find_last_not_of(" \t\r") + 1);
+  return rest;
+}
+
+bool ParseVec3(std::istream& stream, glm::vec3& vec) {
+  return static_cast<bool>(stream >> vec.x >> vec.y >> vec.z);
+}
+
+ObjectKeyframe Interpolate(const std::vector<ObjectKeyframe>& keyframes, const uint64_t frame) {
+  const auto next = std::upper_bound(keyframes.begin(), keyframes.end(), frame,
+                                     [](const uint64_t f, const ObjectKeyframe& keyframe) { return f < keyframe.frame; });
+  if (next == keyframes.begin()) {
+    return *next;
+  }
+  const ObjectKeyframe& prev = *(next - 1);
+  if (next == keyframes.end()) {
+    return prev;
+  }
+  const auto t = static_cast<float>(frame - prev.frame) / static_cast<float>(next->frame - prev.frame);
+  ObjectKeyframe keyframe = {};
+  keyframe.frame = frame;
+  keyframe.translation = glm::mix(prev.translation, next->translation, t);
+  keyframe.rotation = glm::slerp(prev.rotation, next->rotation, t);
+  keyframe.scale = glm::mix(prev.scale, next->scale, t);
+  return keyframe;
+}
+
+} // namespace
+
+Scenario::Scenario() : near_plane_(0.0f), far_plane_(0.0f), frame_count_(0) {}
+
+Scenario Scenario::FromFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw Error("failed to open scenario " + path);
+  }
+  const std::filesystem::path dir = std::filesystem::path(path).parent_path();
+
+  Scenario scenario;
+  std::vector<CameraKeyframe> camera_keyframes;
+  std::string line;
+  for(size_t line_number = 1; std::getline(file, line); ++line_number) {
+    const auto fail = [&](const std::string& message) {
+      return Error(path + ":" + std::to_string(line_number) + ": " + message);
+    };
+    std::istringstream stream(line);
+    std::string directive;
+    if (!(stream >> directive) || directive[0] == '#') {
+      continue;
+    }
+    if (directive == "frames") {
+      if (!(stream >> scenario.frame_count_)) {
+        throw fail("invalid frame count");
+      }
+    } else if (directive == "model") {
+      const std::filesystem::path model = ReadRest(stream);
+      if (model.empty()) {
+        throw fail("missing model path");
+      }
+      scenario.models_.push_back((model.is_absolute() ? model : dir / model).string());
+    } else if (directive == "object") {
+      ScenarioObject object = {};
+      if (!(stream >> object.model) || object.model >= scenario.models_.size()) {
+        throw fail("invalid model index");
+      }
+      object.spin_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+      scenario.objects_.push_back(object);
+    } else if (directive == "camera") {
+      CameraKeyframe keyframe = {};
+      if (!CameraScript::ParseKeyframe(stream, keyframe)) {
+        throw fail("invalid camera keyframe");
+      }
+      camera_keyframes.push_back(keyframe);
+    } else if (directive == "clip") {
+      if (!(stream >> scenario.near_plane_ >> scenario.far_plane_) ||
+          scenario.near_plane_ <= 0.0f || scenario.far_plane_ <= scenario.near_plane_) {
+        throw fail("invalid clip planes");
+      }
+    } else if (directive == "key") {
+      size_t object;
+      ObjectKeyframe keyframe = {};
+      glm::vec3 axis;
+      float degrees;
+      if (!(stream >> object >> keyframe.frame) || !ParseVec3(stream, keyframe.translation) ||
+          !ParseVec3(stream, axis) || !(stream >> degrees) || !ParseVec3(stream, keyframe.scale)) {
+        throw fail("invalid object keyframe");
+      }
+      if (object >= scenario.objects_.size()) {
+        throw fail("invalid object index");
+      }
+      std::vector<ObjectKeyframe>& keyframes = scenario.objects_[object].keyframes;
+      if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame) {
+        throw fail("object keyframes are not in increasing frame order");
+      }
+      keyframe.rotation = glm::angleAxis(glm::radians(degrees), glm::normalize(axis));
+      keyframes.push_back(keyframe);
+    } else if (directive == "spin") {
+      size_t object;
+      glm::vec3 axis;
+      double degrees;
+      if (!(stream >> object) || !ParseVec3(stream, axis) || !(stream >> degrees)) {
+        throw fail("invalid spin");
+      }
+      if (object >= scenario.objects_.size()) {
+        throw fail("invalid object index");
+      }
+      scenario.objects_[object].spin_axis = glm::normalize(axis);
+      scenario.objects_[object].spin_degrees = degrees;
+    } else {
+      throw fail("unknown directive " + directive);
+    }
+  }
+  scenario.camera_script_ = CameraScript(std::move(camera_keyframes));
+  return scenario;
+}
+
+Scenario Scenario::FromModel(const std::string& model_path) {
+  Scenario scenario;
+  scenario.models_.push_back(model_path);
+
+  ScenarioObject object = {};
+  object.model = 0;
+  object.spin_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+  object.spin_degrees = 1.0;
+  scenario.objects_.push_back(object);
+  return scenario;
+}
+
+std::vector<ObjectId> Scenario::Load(Renderer& renderer) const {
+  std::vector<MeshId> meshes;
+  meshes.reserve(models_.size());
+  for(const std::string& model : models_) {
+    meshes.push_back(renderer.LoadMesh(model));
+  }
+  std::vector<ObjectId> objects;
+  objects.reserve(objects_.size());
+  for(const ScenarioObject& object : objects_) {
+    objects.push_back(renderer.GetScene().AddObject(meshes[object.model]));
+  }
+  return objects;
+}
+
+void Scenario::Apply(Scene& scene, const std::vector<ObjectId>& objects, const uint64_t frame) const {
+  for(size_t i = 0; i < objects_.size(); ++i) {
+    const ScenarioObject& object = objects_[i];
+    // Like the camera, a held pose is only set on frame 0, so static objects
+    // cost no transform updates.
+    const bool held = object.keyframes.empty() || frame <= object.keyframes.front().frame || frame > object.keyframes.back().frame;
+    if (frame != 0 && held && object.spin_degrees == 0.0) {
+      continue;
+    }
+    ObjectKeyframe transform = {};
+    transform.rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    transform.scale = glm::vec3(1.0f);
+    if (!object.keyframes.empty()) {
+      transform = Interpolate(object.keyframes, frame);
+    }
+    // Wrapped in double precision, so the angle stays exact over long runs.
+    if (object.spin_degrees != 0.0) {
+      const auto degrees = static_cast<float>(std::fmod(object.spin_degrees * static_cast<double>(frame), 360.0));
+      transform.rotation = glm::angleAxis(glm::radians(degrees), object.spin_axis) * transform.rotation;
+    }
+    scene.SetTransform(objects[i], transform.translation, transform.rotation, transform.scale);
+  }
+  if (frame == 0 && far_plane_ > 0.0f) {
+    scene.SetClipPlanes(near_plane_, far_plane_);
+  }
+  camera_script_.Apply(scene, frame);
+}
+
+} // namespace engine
@@ -0,0 +1,89 @@
+#ifndef ENGINE_SCENARIO_H_
+#define ENGINE_SCENARIO_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "engine/camera_script.h"
+#include "engine/render/renderer.h"
+
+namespace engine {
+
+struct ObjectKeyframe {
+  uint64_t frame;
+  glm::vec3 translation;
+  glm::quat rotation;
+  glm::vec3 scale;
+};
+
+struct ScenarioObject {
+  size_t model;
+  // Interpolated like the camera: translation and scale linearly, rotation
+  // along the shorter arc. Without keyframes the object sits at the origin.
+  std::vector<ObjectKeyframe> keyframes;
+  // Turn added on top of the keyframes, in degrees per frame.
+  glm::vec3 spin_axis;
+  double spin_degrees;
+};
+
+// What to load and how every frame looks, as a function of the frame index
+// alone, so a run renders the same frames on every machine whatever its
+// frame rate.
+class Scenario {
+public:
+  // One directive per line, blank lines and lines starting with # skipped:
+  //   frames N                     frames to run, unless a limit is set
+  //   model PATH                   mesh to load, PATH taking the rest of the
+  //                                line, relative to the scenario file
+  //   object MODEL                 instance of the MODEL-th model line
+  //   camera FRAME EX EY EZ TX TY TZ
+  //   clip NEAR FAR                fixed camera near and far planes, which
+  //                                otherwise follow the eye to target
+  //                                distance
+  //   key OBJECT FRAME TX TY TZ AX AY AZ DEGREES SX SY SZ
+  //   spin OBJECT AX AY AZ DEGREES_PER_FRAME
+  // Objects are numbered in the order of their object lines, and camera and
+  // key frames of one object must be strictly increasing.
+  [[nodiscard]] static Scenario FromFile(const std::string& path);
+  // One object of the model turning a degree a frame about z under the
+  // default camera.
+  [[nodiscard]] static Scenario FromModel(const std::string& model_path);
+
+  void SetCameraScript(CameraScript camera_script);
+
+  // Loads every model and adds the objects, returning their ids in order.
+  [[nodiscard]] std::vector<ObjectId> Load(Renderer& renderer) const;
+  // Sets the camera and object transforms of the frame, for consecutive
+  // frames from 0 on the same scene. Only what moved since the previous
+  // frame is set.
+  void Apply(Scene& scene, const std::vector<ObjectId>& objects, uint64_t frame) const;
+
+  // Zero when the scenario does not say.
+  [[nodiscard]] uint64_t frame_count() const noexcept;
+private:
+  Scenario();
+
+  std::vector<std::string> models_;
+  std::vector<ScenarioObject> objects_;
+  CameraScript camera_script_;
+  // Zero far plane when the scenario does not fix them.
+  float near_plane_;
+  float far_plane_;
+  uint64_t frame_count_;
+};
+
+inline void Scenario::SetCameraScript(CameraScript camera_script) {
+  camera_script_ = std::move(camera_script);
+}
+
+inline uint64_t Scenario::frame_count() const noexcept {
+  return frame_count_;
+}
+
+} // namespace engine
+
+#endif // ENGINE_SCENARIO_H_
@@ -21,6 +21,9 @@ public:
   virtual ~Window() = default;
 
   [[nodiscard]] virtual bool ShouldClose() const noexcept = 0;
+  // False for windows without a display that never close by themselves,
+  // whose runs need a frame limit to finish.
+  [[nodiscard]] virtual bool IsClosable() const noexcept;
   virtual void Loop() const = 0;
 
   virtual void SetWindowTitle(const std::string& title) = 0;
@@ -31,6 +34,10 @@ public:
   [[nodiscard]] virtual int GetHeight() const noexcept = 0;
 };
 
+inline bool Window::IsClosable() const noexcept {
+  return true;
+}
+
 } // namespace engine
 
 #endif // ENGINE_WINDOW_WINDOW_H_
@@ -4,6 +4,22 @@
 
 namespace engine {
 
+#ifdef ENGINE_STATIC_PLUGINS
+
+WindowLoader::WindowLoader(const std::string& path) {
+  CheckLinkedLibrary(path, ENGINE_STATIC_WINDOW_NAME "_" ENGINE_STATIC_RENDERER_NAME "_window");
+}
+
+Instance::Handle WindowLoader::LoadInstance() const {
+  return {PluginCreateInstance(), PluginDestroyInstance};
+}
+
+Window::Handle WindowLoader::LoadWindow(const int width, const int height, const std::string& title) const {
+  return {PluginCreateWindow(width, height, title), PluginDestroyWindow};
+}
+
+#else
+
 WindowLoader::WindowLoader(const std::string& path) : DllLoader(path) {}
 
 Instance::Handle WindowLoader::LoadInstance() const {
@@ -18,5 +34,6 @@ Window::Handle WindowLoader::LoadWindow(const int width, const int height, const
   return {create_window(width, height, title), destroy_window};
 }
 
+#endif // ENGINE_STATIC_PLUGINS
 
 } // namespace engine
\ No newline at end of file
@@ -4,13 +4,37 @@
 #include <cstdlib>
 #include <iostream>
 
-int main() {
-  const engine::Config config(engine::RendererType::kVk, engine::WindowType::kSdl);
+#include "trace/trace.h"
+
+namespace {
+
+#ifdef ENGINE_STATIC_PLUGINS
+constexpr std::string_view kDefaultRenderer = ENGINE_STATIC_RENDERER_NAME;
+constexpr std::string_view kDefaultWindow = ENGINE_STATIC_WINDOW_NAME;
+#else
+constexpr std::string_view kDefaultRenderer = engine::RendererType::kVk;
+constexpr std::string_view kDefaultWindow = engine::WindowType::kSdl;
+#endif
+
+// ENGINE_RENDERER and ENGINE_WINDOW pick the plugins, e.g. vk and headless.
+// A build with a backend linked in only accepts that pair.
+std::string_view GetPluginName(const char* env_name, const std::string_view default_name) {
+  const char* env = std::getenv(env_name);
+  return env != nullptr ? env : default_name;
+}
 
-  const engine::WindowLoader window_loader(config.window_plugin_path);
-  const engine::RendererLoader renderer_loader(config.renderer_plugin_path);
+} // namespace
+
+int main() {
+  TRACE_THREAD_NAME("main");
   try {
-    engine::Runner runner(renderer_loader, window_loader, config.title);
+    const engine::Config config(GetPluginName("ENGINE_RENDERER", kDefaultRenderer),
+                                GetPluginName("ENGINE_WINDOW", kDefaultWindow));
+
+    const engine::WindowLoader window_loader(config.window_plugin_path);
+    const engine::RendererLoader renderer_loader(config.renderer_plugin_path);
+
+    engine::Runner runner(renderer_loader, window_loader, config);
     runner.Run();
     return EXIT_SUCCESS;
   } catch (const std::exception& error) {
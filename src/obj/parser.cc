@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 
 #include "obj/error.h"
+#include "trace/trace.h"
 #include "mapbox/earcut.hpp"
 
 namespace obj {
@@ -386,6 +387,7 @@ void ParseBuffer(const char* ptr, const char* end, Data& data) {
 }  // namespace
 
 Data ParseFromFile(const std::string& path) {
+  TRACE_ZONE("obj::ParseFromFile");
   Data data = {};
   std::ifstream file(path.data(), std::ifstream::binary);
   if (!file.is_open()) {
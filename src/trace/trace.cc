@@ -0,0 +1,230 @@
+#include "trace/trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+constexpr size_t kChunkSize = 4096;
+constexpr const char* kDefaultPath = "engine_trace.json";
+
+enum class EventType : uint8_t {
+  kZone,
+  kCounter
+};
+
+struct Event {
+  EventType type;
+  uint32_t name;
+  uint64_t time;
+  // End time of a zone, value of a counter.
+  union {
+    uint64_t end;
+    double value;
+  };
+};
+
+// Written by its thread only. Events below count are published with a
+// release store, so the writer reads them without taking a lock.
+struct Chunk {
+  std::array<Event, kChunkSize> events;
+  std::atomic<size_t> count{0};
+  std::atomic<Chunk*> next{nullptr};
+};
+
+// Owned by the registry rather than the thread, so the events of threads
+// that have exited are still written.
+struct ThreadBuffer {
+  explicit ThreadBuffer(uint32_t id);
+  ~ThreadBuffer();
+
+  ThreadBuffer(const ThreadBuffer&) = delete;
+  ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+  void Append(const Event& event);
+
+  uint32_t id;
+  // Guarded by the registry mutex.
+  std::string name;
+  Chunk* head;
+  Chunk* tail;
+};
+
+ThreadBuffer::ThreadBuffer(const uint32_t id) : id(id), head(new Chunk), tail(head) {}
+
+ThreadBuffer::~ThreadBuffer() {
+  for(Chunk* chunk = head; chunk != nullptr;) {
+    Chunk* next = chunk->next.load(std::memory_order_relaxed);
+    delete chunk;
+    chunk = next;
+  }
+}
+
+void ThreadBuffer::Append(const Event& event) {
+  size_t count = tail->count.load(std::memory_order_relaxed);
+  if (count == kChunkSize) {
+    auto* chunk = new Chunk;
+    tail->next.store(chunk, std::memory_order_release);
+    tail = chunk;
+    count = 0;
+  }
+  tail->events[count] = event;
+  tail->count.store(count + 1, std::memory_order_release);
+}
+
+void WriteString(std::ostream& stream, const std::string& string) {
+  stream << '"';
+  for(const char c : string) {
+    if (c == '"' || c == '\\') {
+      stream << '\\';
+    }
+    stream << c;
+  }
+  stream << '"';
+}
+
+class Registry {
+public:
+  static Registry& Get();
+
+  uint32_t Intern(const char* name);
+  ThreadBuffer& GetThreadBuffer();
+  void SetThreadName(const std::string& name);
+  void Write(std::ostream& stream);
+private:
+  Registry();
+
+  std::mutex mutex_;
+  uint64_t epoch_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+thread_local ThreadBuffer* thread_buffer = nullptr;
+
+Registry& Registry::Get() {
+  static Registry registry;
+  return registry;
+}
+
+Registry::Registry() : epoch_(Now()) {}
+
+uint32_t Registry::Intern(const char* name) {
+  std::lock_guard lock(mutex_);
+  const auto [it, inserted] = name_ids_.try_emplace(name, static_cast<uint32_t>(names_.size()));
+  if (inserted) {
+    names_.emplace_back(name);
+  }
+  return it->second;
+}
+
+ThreadBuffer& Registry::GetThreadBuffer() {
+  if (thread_buffer == nullptr) {
+    std::lock_guard lock(mutex_);
+    buffers_.push_back(std::make_unique<ThreadBuffer>(static_cast<uint32_t>(buffers_.size())));
+    thread_buffer = buffers_.back().get();
+  }
+  return *thread_buffer;
+}
+
+void Registry::SetThreadName(const std::string& name) {
+  ThreadBuffer& buffer = GetThreadBuffer();
+  std::lock_guard lock(mutex_);
+  buffer.name = name;
+}
+
+void Registry::Write(std::ostream& stream) {
+  std::lock_guard lock(mutex_);
+  stream << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  const auto begin_event = [&](const char* phase, const uint32_t name, const uint32_t thread) {
+    stream << (first ? "\n" : ",\n") << "{\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":" << thread << ",\"name\":";
+    WriteString(stream, names_[name]);
+    first = false;
+  };
+  const auto to_microseconds = [this](const uint64_t time) {
+    return static_cast<double>(static_cast<int64_t>(time - epoch_)) / 1e3;
+  };
+  for(const std::unique_ptr<ThreadBuffer>& buffer : buffers_) {
+    if (!buffer->name.empty()) {
+      stream << (first ? "\n" : ",\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+      WriteString(stream, buffer->name);
+      stream << "}}";
+      first = false;
+    }
+    for(const Chunk* chunk = buffer->head; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire)) {
+      const size_t count = chunk->count.load(std::memory_order_acquire);
+      for(size_t i = 0; i < count; ++i) {
+        const Event& event = chunk->events[i];
+        if (event.type == EventType::kZone) {
+          begin_event("X", event.name, buffer->id);
+          stream << ",\"ts\":" << to_microseconds(event.time)
+                 << ",\"dur\":" << static_cast<double>(event.end - event.time) / 1e3 << '}';
+        } else {
+          begin_event("C", event.name, buffer->id);
+          stream << ",\"ts\":" << to_microseconds(event.time)
+                 << ",\"args\":{\"value\":" << event.value << "}}";
+        }
+      }
+    }
+  }
+  stream << "\n]}\n";
+}
+
+} // namespace
+
+uint32_t Intern(const char* name) {
+  return Registry::Get().Intern(name);
+}
+
+uint64_t Now() noexcept {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void RecordZone(const uint32_t name, const uint64_t begin, const uint64_t end) {
+  Event event = {};
+  event.type = EventType::kZone;
+  event.name = name;
+  event.time = begin;
+  event.end = end;
+  Registry::Get().GetThreadBuffer().Append(event);
+}
+
+void RecordCounter(const uint32_t name, const double value) {
+  Event event = {};
+  event.type = EventType::kCounter;
+  event.name = name;
+  event.time = Now();
+  event.value = value;
+  Registry::Get().GetThreadBuffer().Append(event);
+}
+
+void SetThreadName(const std::string& name) {
+  Registry::Get().SetThreadName(name);
+}
+
+void Flush() {
+  const char* env = std::getenv("ENGINE_TRACE_FILE");
+  const std::string path = env != nullptr ? env : kDefaultPath;
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "failed to open trace file " << path << std::endl;
+    return;
+  }
+  Registry::Get().Write(file);
+}
+
+} // namespace trace
@@ -0,0 +1,85 @@
+#ifndef TRACE_TRACE_H_
+#define TRACE_TRACE_H_
+
+// Scoped zones, counters and thread names recorded into per-thread buffers
+// and written as Chrome trace JSON, which both chrome://tracing and Perfetto
+// open. The macros expand to nothing unless ENGINE_TRACING is defined.
+
+#ifdef ENGINE_TRACING
+
+#include <cstdint>
+#include <string>
+
+#if defined(_WIN32) && !defined(__MINGW32__)
+#   ifdef TRACE_EXPORT
+#     define TRACE_API __declspec(dllexport)
+#   else
+#     define TRACE_API __declspec(dllimport)
+#   endif
+#else
+#   define TRACE_API __attribute__ ((visibility ("default")))
+#endif
+
+namespace trace {
+
+// The registry lives in the trace shared library, so the executable and
+// every dlopen'ed plugin record into the same one. Names are copied and
+// interned once per call site: events keep an id rather than a pointer into
+// a plugin that may be unloaded before the trace is written.
+TRACE_API uint32_t Intern(const char* name);
+// Nanoseconds on the steady clock.
+TRACE_API uint64_t Now() noexcept;
+TRACE_API void RecordZone(uint32_t name, uint64_t begin, uint64_t end);
+TRACE_API void RecordCounter(uint32_t name, double value);
+TRACE_API void SetThreadName(const std::string& name);
+// Writes the events recorded so far to ENGINE_TRACE_FILE, engine_trace.json
+// by default. Other threads may keep recording meanwhile.
+TRACE_API void Flush();
+
+class Zone {
+public:
+  explicit Zone(uint32_t name) noexcept;
+  ~Zone();
+
+  Zone(const Zone&) = delete;
+  Zone& operator=(const Zone&) = delete;
+private:
+  uint32_t name_;
+  uint64_t begin_;
+};
+
+inline Zone::Zone(const uint32_t name) noexcept : name_(name), begin_(Now()) {}
+
+inline Zone::~Zone() {
+  RecordZone(name_, begin_, Now());
+}
+
+} // namespace trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing scope. name must be a string literal.
+#define TRACE_ZONE(name) \
+  static const uint32_t TRACE_CONCAT(trace_name_, __LINE__) = ::trace::Intern(name); \
+  const ::trace::Zone TRACE_CONCAT(trace_zone_, __LINE__)(TRACE_CONCAT(trace_name_, __LINE__))
+
+#define TRACE_COUNTER(name, value) \
+  do { \
+    static const uint32_t trace_counter_name = ::trace::Intern(name); \
+    ::trace::RecordCounter(trace_counter_name, static_cast<double>(value)); \
+  } while (false)
+
+#define TRACE_THREAD_NAME(name) ::trace::SetThreadName(name)
+#define TRACE_FLUSH() ::trace::Flush()
+
+#else
+
+#define TRACE_ZONE(name) static_cast<void>(0)
+#define TRACE_COUNTER(name, value) static_cast<void>(0)
+#define TRACE_THREAD_NAME(name) static_cast<void>(0)
+#define TRACE_FLUSH() static_cast<void>(0)
+
+#endif // ENGINE_TRACING
+
+#endif // TRACE_TRACE_H_